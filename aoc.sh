@@ -2,23 +2,5 @@
 #cmake -B build -GNinja -DCMAKE_BUILD_TYPE=Debug
 #cmake --build build
 
-./build/day1
-./build/day2
-./build/day3
-./build/day4
-./build/day5
-./build/day6
-./build/day7
-./build/day8
-./build/day9
-./build/day10
-./build/day11
-./build/day12
-./build/day13
-./build/day14
-./build/day15
-./build/day16
-./build/day17
-./build/day18
-./build/day19
-./build/day20
+# one process for everything, times for each phase go to stderr
+./build/aoc "$@"
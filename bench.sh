@@ -0,0 +1,6 @@
+# benchmarks every day, pass --benchmark_filter=dayN/ to pick some
+#cmake -B build -GNinja -DCMAKE_BUILD_TYPE=RelWithDebInfo
+#cmake --build build
+
+# the console gets the usual table, bench_output.json the full results
+./build/bench_days --benchmark_out=bench_output.json --benchmark_out_format=json "$@"
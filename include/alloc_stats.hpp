@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <optional>
+
+#ifndef AOC_ALLOC_STATS
+#define AOC_ALLOC_STATS 0
+#endif
+
+namespace utils {
+  // Set with -DAOC_ALLOC_STATS=1, which also links src/alloc_hook.cpp's operator new in
+  // to do the counting. Otherwise AllocScope does nothing and the counts stay at zero.
+  inline constexpr bool AllocStats = AOC_ALLOC_STATS;
+
+  struct alloc_stats_t {
+    size_t allocations = 0;
+    size_t bytes = 0;
+    std::optional<size_t> peak_rss; // kB, for the whole process, if it was measured
+
+    alloc_stats_t& operator+=(const alloc_stats_t& other) {
+      allocations += other.allocations;
+      bytes += other.bytes;
+      if (other.peak_rss) peak_rss = std::max(peak_rss.value_or(0), *other.peak_rss);
+      return *this;
+    }
+  };
+
+  namespace alloc {
+    struct counts_t {
+      size_t allocations = 0;
+      size_t bytes = 0;
+    };
+
+    // Everything operator new has handed out on this thread
+    inline thread_local counts_t counts;
+
+    // ...and on every thread, but only while some scope is watching, so the days don't all
+    // contend on them otherwise
+    inline std::atomic<size_t> allocations = 0;
+    inline std::atomic<size_t> bytes = 0;
+    inline std::atomic<size_t> watching = 0;
+
+    inline counts_t everywhere() { return {allocations.load(), bytes.load()}; }
+
+    // The most the process has had resident since it started, or since resetPeakRss().
+    // 0 if /proc isn't there to ask.
+    inline size_t peakRss() {
+      auto status = fopen("/proc/self/status", "r");
+      if (!status) return 0;
+      size_t kb = 0;
+      char line[256];
+      while (fgets(line, sizeof(line), status)) {
+        if (sscanf(line, "VmHWM: %zu kB", &kb) == 1) break;
+      }
+      fclose(status);
+      return kb;
+    }
+
+    // Brings the peak back down to what's resident now (Linux 4.0 and up)
+    inline void resetPeakRss() {
+      if (auto refs = fopen("/proc/self/clear_refs", "w")) {
+        fputs("5", refs);
+        fclose(refs);
+      }
+    }
+  }
+
+  // Counts the allocations made in the scope it's in into `out`, along with the process's
+  // peak RSS over it. An exclusive scope, one nothing else runs alongside, counts them on
+  // every thread, so work handed to a pool is included. Scopes that might overlap others
+  // would count each other's that way, and would reset each other's peaks, so they only
+  // count the allocations made on their own thread and go without the peak.
+  template<bool Enabled>
+  class BasicAllocScope {
+    public:
+    explicit BasicAllocScope(alloc_stats_t& out, bool exclusive = true) : out_(out), exclusive_(exclusive) {
+      if (exclusive_) {
+        ++alloc::watching;
+        alloc::resetPeakRss();
+      }
+      start_ = counts();
+    }
+    BasicAllocScope(const BasicAllocScope&) = delete;
+    BasicAllocScope& operator=(const BasicAllocScope&) = delete;
+    ~BasicAllocScope() {
+      const auto end = counts();
+      out_.allocations = end.allocations - start_.allocations;
+      out_.bytes = end.bytes - start_.bytes;
+      if (exclusive_) {
+        --alloc::watching;
+        out_.peak_rss = alloc::peakRss();
+      }
+    }
+
+    private:
+    alloc::counts_t counts() const { return exclusive_ ? alloc::everywhere() : alloc::counts; }
+
+    alloc_stats_t& out_;
+    bool exclusive_;
+    alloc::counts_t start_;
+  };
+
+  template<>
+  class BasicAllocScope<false> {
+    public:
+    explicit BasicAllocScope(alloc_stats_t&, bool = true) {}
+  };
+
+  using AllocScope = BasicAllocScope<AllocStats>;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "hash.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils {
+  // Answers already worked out, keyed on the day and a hash of the input, so an input seen
+  // before can be answered without parsing or solving it again.
+  //
+  // The table is a file of fixed-size slots mapped into memory and shared with any other
+  // process using the same file, which flock() keeps apart. A key's slot is picked by its
+  // hash, then the next few are tried. When they're all taken the first is overwritten, so
+  // the file never grows. Answers too long to fit aren't stored.
+  //
+  // Nothing notices a day's code changing its answers, so delete the file after fixing one
+  // (bumping Version does it for everyone).
+  class AnswerCache {
+    public:
+    static constexpr uint32_t Version = 1;
+    static constexpr uint32_t Slots = 1 << 14;
+    static constexpr size_t Probes = 8;
+
+    struct answers_t {
+      std::string part1;
+      std::optional<std::string> part2;
+    };
+
+    struct stats_t {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t stores = 0;
+    };
+
+    explicit AnswerCache(const std::string& path) {
+      fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+      if (fd_ == -1) throw std::runtime_error(fmt::format("can't open the answer cache {}", path));
+      flock(fd_, LOCK_EX);
+      struct stat st;
+      fstat(fd_, &st);
+      // anything that isn't a table we'd have written is started afresh
+      header_t header{};
+      const bool valid = st.st_size == FileSize && pread(fd_, &header, sizeof(header), 0) == sizeof(header) &&
+          std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version && header.slots == Slots;
+      if (!valid) {
+        header = {.magic = {}, .version = Version, .slots = Slots, .padding = {}};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        if (ftruncate(fd_, 0) != 0 || ftruncate(fd_, FileSize) != 0 || pwrite(fd_, &header, sizeof(header), 0) != sizeof(header)) {
+          flock(fd_, LOCK_UN);
+          close(fd_);
+          throw std::runtime_error(fmt::format("can't write the answer cache {}", path));
+        }
+      }
+      flock(fd_, LOCK_UN);
+
+      map_ = mmap(nullptr, FileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (map_ == MAP_FAILED) {
+        close(fd_);
+        throw std::runtime_error(fmt::format("can't map the answer cache {}", path));
+      }
+      slots_ = reinterpret_cast<slot_t*>(static_cast<char*>(map_) + sizeof(header_t));
+    }
+    AnswerCache(const AnswerCache&) = delete;
+    AnswerCache& operator=(const AnswerCache&) = delete;
+    ~AnswerCache() {
+      munmap(map_, FileSize);
+      close(fd_);
+    }
+
+    std::optional<answers_t> find(int day, hash128_t hash) {
+      Locked lock{*this, LOCK_SH};
+      for (size_t i = 0; i < Probes; ++i) {
+        const auto& slot = slots_[(hash.lo + i) % Slots];
+        if (slot.matches(day, hash) && slot.fits()) {
+          ++stats_.hits;
+          answers_t result{.part1 = std::string{slot.answers, slot.part1}, .part2 = std::nullopt};
+          if (slot.part2 != NoPart2) result.part2 = std::string{slot.answers + slot.part1, slot.part2};
+          return result;
+        }
+      }
+      ++stats_.misses;
+      return std::nullopt;
+    }
+
+    void store(int day, hash128_t hash, const answers_t& answers) {
+      const size_t part2 = answers.part2 ? answers.part2->size() : 0;
+      if (answers.part1.size() + part2 > sizeof(slot_t::answers)) return;
+
+      Locked lock{*this, LOCK_EX};
+      // the key's own slot if it's there already, else the first free one, else the first
+      slot_t* into = &slots_[hash.lo % Slots];
+      for (size_t i = 0; i < Probes; ++i) {
+        auto& slot = slots_[(hash.lo + i) % Slots];
+        if (slot.matches(day, hash) || slot.day == 0) {
+          into = &slot;
+          break;
+        }
+      }
+      into->lo = hash.lo;
+      into->hi = hash.hi;
+      into->day = day;
+      into->part1 = answers.part1.size();
+      into->part2 = answers.part2 ? part2 : NoPart2;
+      std::memcpy(into->answers, answers.part1.data(), answers.part1.size());
+      if (answers.part2) std::memcpy(into->answers + answers.part1.size(), answers.part2->data(), part2);
+      ++stats_.stores;
+    }
+
+    stats_t stats() const {
+      std::lock_guard lock{mutex_};
+      return stats_;
+    }
+
+    private:
+    static constexpr char Magic[8] = {'a', 'o', 'c', 'c', 'a', 'c', 'h', 'e'};
+    static constexpr uint8_t NoPart2 = 0xFF;
+
+    struct header_t {
+      char magic[8];
+      uint32_t version;
+      uint32_t slots;
+      char padding[48];
+    };
+
+    // A cache line each. day is 0 in a slot that's never been used.
+    struct slot_t {
+      uint64_t lo;
+      uint64_t hi;
+      uint16_t day;
+      uint8_t part1;
+      uint8_t part2;
+      char answers[44];
+
+      bool matches(int d, hash128_t hash) const { return day == d && lo == hash.lo && hi == hash.hi; }
+      // Anyone can write to the file, so lengths that run off the slot are a miss
+      bool fits() const { return size_t{part1} + (part2 == NoPart2 ? 0 : part2) <= sizeof(answers); }
+    };
+    static_assert(sizeof(header_t) == 64 && sizeof(slot_t) == 64);
+    static constexpr size_t FileSize = sizeof(header_t) + Slots * sizeof(slot_t);
+
+    // Threads in this process go through the mutex, other processes through the file lock
+    class Locked {
+      public:
+      Locked(AnswerCache& cache, int mode) : cache_(cache), lock_(cache.mutex_) { flock(cache_.fd_, mode); }
+      Locked(const Locked&) = delete;
+      Locked& operator=(const Locked&) = delete;
+      ~Locked() { flock(cache_.fd_, LOCK_UN); }
+
+      private:
+      AnswerCache& cache_;
+      std::lock_guard<std::mutex> lock_;
+    };
+
+    int fd_ = -1;
+    void* map_ = MAP_FAILED;
+    slot_t* slots_ = nullptr;
+    mutable std::mutex mutex_;
+    stats_t stats_;
+  };
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+
+#include <fmt/core.h>
+
+#ifndef AOC_ARENA_STATS
+#define AOC_ARENA_STATS 0
+#endif
+
+namespace utils {
+  // Set with -DAOC_ARENA_STATS=1 to have the days report what went through their arenas
+  inline constexpr bool ArenaStats = AOC_ARENA_STATS;
+
+  // Monotonic bump allocator for everything a solve needs. Memory comes from upstream in
+  // blocks that double in size, deallocation does nothing, and it all goes back at once
+  // with release() (or reset(), which hangs on to the biggest block for next time).
+  class Arena : public std::pmr::memory_resource {
+    public:
+    struct stats_t {
+      size_t allocations = 0;
+      size_t bytes = 0;
+      size_t deallocations = 0;
+      size_t blocks = 0;         // upstream allocations
+      size_t block_bytes = 0;
+    };
+
+    explicit Arena(size_t initial_block = 64 << 10,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : upstream_(upstream), next_block_(std::max(initial_block, sizeof(block_t) * 2)) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    // Hands every block back upstream
+    void release() {
+      while (head_) {
+        auto prev = head_->prev;
+        upstream_->deallocate(head_, head_->size, alignof(block_t));
+        head_ = prev;
+      }
+      cur_ = end_ = nullptr;
+    }
+
+    // Forgets everything allocated and starts the stats afresh, but keeps the most recent
+    // (largest) block to reuse
+    void reset() {
+      stats_ = {};
+      if (!head_) return;
+      auto keep = head_;
+      head_ = head_->prev;
+      release();
+      keep->prev = nullptr;
+      head_ = keep;
+      cur_ = reinterpret_cast<std::byte*>(keep + 1);
+      end_ = reinterpret_cast<std::byte*>(keep) + keep->size;
+    }
+
+    const stats_t& stats() const { return stats_; }
+
+    void report(std::string_view name) const {
+      fmt::println(stderr, "{}: arena served {} allocations ({} bytes, {} freed) from {} upstream blocks ({} bytes)",
+          name, stats_.allocations, stats_.bytes, stats_.deallocations, stats_.blocks, stats_.block_bytes);
+    }
+
+    private:
+    struct block_t {
+      block_t* prev;
+      size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+      ++stats_.allocations;
+      stats_.bytes += bytes;
+      if (auto p = bump(bytes, alignment)) return p;
+      newBlock(bytes + alignment);
+      return bump(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override { ++stats_.deallocations; }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    void* bump(size_t bytes, size_t alignment) {
+      if (!cur_) return nullptr;
+      void* p = cur_;
+      size_t space = end_ - cur_;
+      if (!std::align(alignment, bytes, p, space)) return nullptr;
+      cur_ = static_cast<std::byte*>(p) + bytes;
+      return p;
+    }
+
+    void newBlock(size_t min_bytes) {
+      const auto size = std::max(next_block_, min_bytes + sizeof(block_t));
+      next_block_ = size * 2;
+      auto block = static_cast<block_t*>(upstream_->allocate(size, alignof(block_t)));
+      block->prev = head_;
+      block->size = size;
+      head_ = block;
+      cur_ = reinterpret_cast<std::byte*>(block + 1);
+      end_ = reinterpret_cast<std::byte*>(block) + size;
+      ++stats_.blocks;
+      stats_.block_bytes += size;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t next_block_;
+    block_t* head_ = nullptr;
+    std::byte* cur_ = nullptr;
+    std::byte* end_ = nullptr;
+    stats_t stats_;
+  };
+}
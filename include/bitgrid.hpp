@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <immintrin.h>
+
+namespace utils {
+  // A width x height grid of bits, each row an array of 64-bit words with column c in bit
+  // c % 64 of word c / 64. Whole-grid and whole-row operations work a word (or with AVX2,
+  // four words) at a time rather than a cell at a time.
+  //
+  // Bits past the width in each row's last word are always kept clear, so counts and
+  // comparisons can take whole words.
+  class BitGrid {
+    public:
+    BitGrid() = default;
+    BitGrid(size_t width, size_t height)
+      : width_(width), height_(height), words_((width + 63) / 64), bits_(words_ * height) {}
+
+    // A bit for every cell of a grid (anything with width(), height() and (row, col)) that
+    // `pred` is true for
+    template<typename Grid, typename Pred>
+    static BitGrid from(const Grid& grid, Pred pred) {
+      BitGrid result(grid.width(), grid.height());
+      for (size_t r = 0; r < grid.height(); ++r) {
+        for (size_t c = 0; c < grid.width(); ++c) {
+          if (pred(grid(r, c))) result.set(r, c);
+        }
+      }
+      return result;
+    }
+
+    size_t width() const { return width_; }
+    size_t height() const { return height_; }
+    size_t wordsPerRow() const { return words_; }
+
+    bool test(size_t r, size_t c) const { return (bits_[r * words_ + c / 64] >> (c % 64)) & 1; }
+    void set(size_t r, size_t c) { bits_[r * words_ + c / 64] |= uint64_t{1} << (c % 64); }
+    void reset(size_t r, size_t c) { bits_[r * words_ + c / 64] &= ~(uint64_t{1} << (c % 64)); }
+    void clear() { std::fill(bits_.begin(), bits_.end(), 0); }
+
+    std::span<uint64_t> row(size_t r) { return {bits_.data() + r * words_, words_}; }
+    std::span<const uint64_t> row(size_t r) const { return {bits_.data() + r * words_, words_}; }
+
+    // Set bits in one row, and in the whole grid
+    size_t count(size_t r) const { return popcount(row(r)); }
+    size_t count() const { return popcount(bits_); }
+    bool none() const { return std::all_of(bits_.begin(), bits_.end(), [](uint64_t w) { return w == 0; }); }
+
+    // Set bits in columns [from, to) of row r, and setting (or clearing) all of them, a word
+    // at a time
+    size_t count(size_t r, size_t from, size_t to) const {
+      size_t result = 0;
+      forRange(from, to, [&](size_t w, uint64_t mask) { result += std::popcount(bits_[r * words_ + w] & mask); });
+      return result;
+    }
+    void fill(size_t r, size_t from, size_t to, bool value = true) {
+      forRange(from, to, [&](size_t w, uint64_t mask) {
+        auto& word = bits_[r * words_ + w];
+        word = value ? word | mask : word & ~mask;
+      });
+    }
+
+    // Which bits differ between two rows, so 0 when they're the same
+    size_t distance(size_t r1, size_t r2) const {
+      size_t result = 0;
+      const auto a = row(r1), b = row(r2);
+      for (size_t w = 0; w < words_; ++w) result += std::popcount(a[w] ^ b[w]);
+      return result;
+    }
+
+    // Cell-wise operations with a grid of the same size
+    BitGrid& operator&=(const BitGrid& other) {
+      return combine(other, [](uint64_t a, uint64_t b) { return a & b; }, [](auto a, auto b) { return _mm256_and_si256(a, b); });
+    }
+    BitGrid& operator|=(const BitGrid& other) {
+      return combine(other, [](uint64_t a, uint64_t b) { return a | b; }, [](auto a, auto b) { return _mm256_or_si256(a, b); });
+    }
+    BitGrid& operator^=(const BitGrid& other) {
+      return combine(other, [](uint64_t a, uint64_t b) { return a ^ b; }, [](auto a, auto b) { return _mm256_xor_si256(a, b); });
+    }
+    // Clears every cell that's set in other
+    BitGrid& andNot(const BitGrid& other) {
+      return combine(other, [](uint64_t a, uint64_t b) { return a & ~b; }, [](auto a, auto b) { return _mm256_andnot_si256(b, a); });
+    }
+
+    friend BitGrid operator&(BitGrid a, const BitGrid& b) { return a &= b; }
+    friend BitGrid operator|(BitGrid a, const BitGrid& b) { return a |= b; }
+    friend BitGrid operator^(BitGrid a, const BitGrid& b) { return a ^= b; }
+
+    // Moves every cell n (under 64) columns towards column 0, or away from it. Cells
+    // pushed off either edge are lost and the ones left behind are cleared.
+    void shiftLeft(unsigned n) {
+      for (size_t r = 0; r < height_; ++r) shiftRowLeft(row(r), n);
+    }
+    void shiftRight(unsigned n) {
+      for (size_t r = 0; r < height_; ++r) shiftRowRight(row(r), n);
+    }
+
+    // Rows become columns, a 64x64 block at a time
+    BitGrid transpose() const {
+      BitGrid result(height_, width_);
+      std::array<uint64_t, 64> block;
+      for (size_t rb = 0; rb < height_; rb += 64) {
+        for (size_t w = 0; w < words_; ++w) {
+          for (size_t i = 0; i < 64; ++i) block[i] = rb + i < height_ ? bits_[(rb + i) * words_ + w] : 0;
+          transpose64(block);
+          for (size_t i = 0; i < 64 && w * 64 + i < width_; ++i) result.bits_[(w * 64 + i) * result.words_ + rb / 64] = block[i];
+        }
+      }
+      return result;
+    }
+
+    // Orders by the bits, row by row, which is enough to key a map on
+    auto operator<=>(const BitGrid&) const = default;
+
+    // Each row of a is the matching column of a afterwards
+    static void transpose64(std::array<uint64_t, 64>& a) {
+      // Swap the off-diagonal 32x32 blocks, then the 16x16 blocks within each of those, and
+      // so on down to single bits
+      uint64_t m = 0x00000000FFFFFFFF;
+      for (unsigned j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+          const uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+          a[k] ^= t << j;
+          a[k | j] ^= t;
+        }
+      }
+    }
+
+    private:
+    static size_t popcount(std::span<const uint64_t> words) {
+      size_t result = 0;
+      size_t i = 0;
+#if defined(__AVX2__)
+      // Count each nibble with a table lookup, then add the byte counts up in sad
+      const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+      const __m256i low = _mm256_set1_epi8(0x0F);
+      __m256i total = _mm256_setzero_si256();
+      for (; i + 4 <= words.size(); i += 4) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data() + i));
+        const auto counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+            _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+      }
+      alignas(32) uint64_t lanes[4];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+      result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+      for (; i < words.size(); ++i) result += std::popcount(words[i]);
+      return result;
+    }
+
+    // Calls f(word, mask) for each word columns [from, to) touch, with the mask of them in it
+    template<typename F>
+    static void forRange(size_t from, size_t to, F f) {
+      if (from >= to) return;
+      const size_t first = from / 64, last = (to - 1) / 64;
+      for (size_t w = first; w <= last; ++w) {
+        uint64_t mask = ~uint64_t{0};
+        if (w == first) mask &= ~uint64_t{0} << (from % 64);
+        if (w == last && to % 64) mask &= (uint64_t{1} << (to % 64)) - 1;
+        f(w, mask);
+      }
+    }
+
+    template<typename Op, typename VectorOp>
+    BitGrid& combine(const BitGrid& other, Op op, [[maybe_unused]] VectorOp vectorOp) {
+      size_t i = 0;
+#if defined(__AVX2__)
+      for (; i + 4 <= bits_.size(); i += 4) {
+        const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits_.data() + i));
+        const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other.bits_.data() + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(bits_.data() + i), vectorOp(a, b));
+      }
+#endif
+      for (; i < bits_.size(); ++i) bits_[i] = op(bits_[i], other.bits_[i]);
+      return *this;
+    }
+
+    void shiftRowLeft(std::span<uint64_t> words, unsigned n) {
+      if (n == 0 || words.empty()) return;
+      size_t w = 0;
+#if defined(__AVX2__)
+      const auto count = _mm_cvtsi32_si128(n), carry = _mm_cvtsi32_si128(64 - n);
+      // each word takes its low bits from the word above it, so stop a word short
+      for (; w + 5 <= words.size(); w += 4) {
+        const auto here = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data() + w));
+        const auto above = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data() + w + 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(words.data() + w),
+            _mm256_or_si256(_mm256_srl_epi64(here, count), _mm256_sll_epi64(above, carry)));
+      }
+#endif
+      for (; w + 1 < words.size(); ++w) words[w] = (words[w] >> n) | (words[w + 1] << (64 - n));
+      words[w] >>= n;
+    }
+
+    void shiftRowRight(std::span<uint64_t> words, unsigned n) {
+      if (n == 0 || words.empty()) return;
+      // from the top down so every word still has the one below it to take bits from
+      size_t w = words.size() - 1;
+#if defined(__AVX2__)
+      const auto count = _mm_cvtsi32_si128(n), carry = _mm_cvtsi32_si128(64 - n);
+      for (; w >= 4; w -= 4) {
+        const auto here = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data() + w - 3));
+        const auto below = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data() + w - 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(words.data() + w - 3),
+            _mm256_or_si256(_mm256_sll_epi64(here, count), _mm256_srl_epi64(below, carry)));
+      }
+#endif
+      for (; w > 0; --w) words[w] = (words[w] << n) | (words[w - 1] >> (64 - n));
+      words[0] <<= n;
+      if (width_ % 64) words.back() &= (uint64_t{1} << (width_ % 64)) - 1;
+    }
+
+    size_t width_ = 0;
+    size_t height_ = 0;
+    size_t words_ = 0;
+    std::vector<uint64_t> bits_;
+  };
+}
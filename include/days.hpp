@@ -0,0 +1,29 @@
+#pragma once
+
+#include "registry.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+// Each day's answers for an input, typed and without going through days(), for calling the
+// solvers from other code. Link the aoc_days library for them.
+namespace day1 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day2 { utils::Answers<int, int> solve(std::string_view input); }
+namespace day3 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day4 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day5 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
+namespace day6 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
+namespace day7 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day8 { utils::Answers<int64_t, size_t> solve(std::string_view input); }
+namespace day9 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
+namespace day10 { utils::Answers<int64_t> solve(std::string_view input); }
+namespace day11 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
+namespace day12 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day13 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day14 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day15 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day16 { utils::Answers<uint64_t, uint64_t> solve(std::string_view input); }
+namespace day17 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
+namespace day18 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
+namespace day19 { utils::Answers<int64_t, uint64_t> solve(std::string_view input); }
+namespace day20 { utils::Answers<int64_t, int64_t> solve(std::string_view input); }
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace utils {
+  // Every `stride`th element from `first`, e.g. a column of a grid
+  template<typename T>
+  class StridedView {
+    public:
+    class iterator {
+      public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = std::remove_const_t<T>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = T*;
+      using reference = T&;
+
+      iterator() = default;
+      iterator(T* p, std::ptrdiff_t stride) : p_(p), stride_(stride) {}
+      T& operator*() const { return *p_; }
+      iterator& operator++() { p_ += stride_; return *this; }
+      iterator operator++(int) { auto old = *this; p_ += stride_; return old; }
+      bool operator==(const iterator& other) const { return p_ == other.p_; }
+
+      private:
+      T* p_ = nullptr;
+      std::ptrdiff_t stride_ = 0;
+    };
+
+    StridedView(T* first, std::ptrdiff_t stride, size_t size) : first_(first), stride_(stride), size_(size) {}
+
+    T& operator[](size_t i) const { return first_[i * stride_]; }
+    size_t size() const { return size_; }
+    iterator begin() const { return {first_, stride_}; }
+    iterator end() const { return {first_ + size_ * stride_, stride_}; }
+
+    private:
+    T* first_;
+    std::ptrdiff_t stride_;
+    size_t size_;
+  };
+
+  // A width x height grid in one allocation, with each row `stride()` after the one before.
+  //
+  // Given a border, the grid is surrounded by a ring of cells holding it, so (-1, c),
+  // (height, c), (r, -1) and (r, width) are all fine to read for any cell (r, c) inside.
+  // Walks can then stop when they step onto the border value instead of checking bounds
+  // on every move. The border is there to be read; writing to it is on the caller.
+  //
+  // Cells can also be addressed by a single index(), where the neighbours are ±1 and
+  // ±stride() away.
+  template<typename T>
+  class Grid2D {
+    public:
+    Grid2D() = default;
+    Grid2D(size_t width, size_t height, T fill = {}, std::optional<T> border = std::nullopt)
+      : width_(width), height_(height), pad_(border.has_value()), stride_(width + 2 * pad_),
+        cells_((height + 2 * pad_) * stride_, border.value_or(fill)) {
+      if (pad_) {
+        for (size_t r = 0; r < height_; ++r) std::fill_n(&(*this)(r, 0), width_, fill);
+      }
+    }
+
+    // A grid from text with a line per row, all the same length, each char turned into a
+    // cell by `convert`. Rows are copied straight out of the input, without splitting it
+    // into lines first.
+    template<typename Convert>
+    static Grid2D fromText(std::string_view input, std::optional<T> border, Convert convert) {
+      if (!input.empty() && input.back() == '\n') input.remove_suffix(1);
+      if (input.empty()) return Grid2D(0, 0, T{}, border);
+      const auto lineEnd = input.find('\n');
+      const size_t width = lineEnd == input.npos ? input.size() : lineEnd;
+      // every row but the last has its newline
+      const size_t height = (input.size() + 1) / (width + 1);
+      if (height * (width + 1) != input.size() + 1)
+        throw std::invalid_argument(fmt::format("grid rows aren't all {} wide", width));
+
+      Grid2D grid(width, height, T{}, border);
+      for (size_t r = 0; r < height; ++r) {
+        const auto line = input.substr(r * (width + 1), width);
+        if (r + 1 < height && input[r * (width + 1) + width] != '\n')
+          throw std::invalid_argument(fmt::format("grid rows aren't all {} wide", width));
+        std::transform(line.begin(), line.end(), &grid(r, 0), convert);
+      }
+      return grid;
+    }
+
+    static Grid2D fromText(std::string_view input, std::optional<T> border = std::nullopt) {
+      return fromText(input, border, [](char c) { return static_cast<T>(c); });
+    }
+
+    size_t width() const { return width_; }
+    size_t height() const { return height_; }
+    size_t stride() const { return stride_; }
+    size_t size() const { return width_ * height_; }
+
+    // Where (row, col) lives in the storage, which is also what operator[] takes
+    size_t index(std::ptrdiff_t row, std::ptrdiff_t col) const {
+      return (row + pad_) * static_cast<std::ptrdiff_t>(stride_) + (col + pad_);
+    }
+    T& operator[](size_t idx) { return cells_[idx]; }
+    const T& operator[](size_t idx) const { return cells_[idx]; }
+
+    T& operator()(std::ptrdiff_t row, std::ptrdiff_t col) { return cells_[index(row, col)]; }
+    const T& operator()(std::ptrdiff_t row, std::ptrdiff_t col) const { return cells_[index(row, col)]; }
+
+    std::span<T> row(size_t r) { return {&(*this)(r, 0), width_}; }
+    std::span<const T> row(size_t r) const { return {&(*this)(r, 0), width_}; }
+    StridedView<T> col(size_t c) { return {&(*this)(0, c), static_cast<std::ptrdiff_t>(stride_), height_}; }
+    StridedView<const T> col(size_t c) const { return {&(*this)(0, c), static_cast<std::ptrdiff_t>(stride_), height_}; }
+
+    // A row of a char grid as a string
+    std::string_view line(size_t r) const requires std::same_as<T, char> { return {&(*this)(r, 0), width_}; }
+
+    // Sets every cell inside the border
+    void fill(const T& value) {
+      for (size_t r = 0; r < height_; ++r) std::fill_n(&(*this)(r, 0), width_, value);
+    }
+
+    // Calls f(row, col, cell) for every cell inside the border, a row at a time
+    template<typename F>
+    void forEach(F f) const {
+      for (size_t r = 0; r < height_; ++r) {
+        const T* cells = &(*this)(r, 0);
+        for (size_t c = 0; c < width_; ++c) f(r, c, cells[c]);
+      }
+    }
+
+    // Compares the whole storage, border included, which is all we need for map keys
+    auto operator<=>(const Grid2D&) const = default;
+
+    private:
+    size_t width_ = 0;
+    size_t height_ = 0;
+    std::ptrdiff_t pad_ = 0;
+    size_t stride_ = 0;
+    std::vector<T> cells_;
+  };
+}
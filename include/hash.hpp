@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include <immintrin.h>
+
+namespace utils {
+  struct hash128_t {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    auto operator<=>(const hash128_t&) const = default;
+  };
+
+  namespace detail {
+    inline constexpr std::array<uint64_t, 8> HashKeys = {
+      0x9E3779B97F4A7C15, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9, 0xD6E8FEB86659FD93,
+      0xFF51AFD7ED558CCD, 0xC4CEB9FE1A85EC53, 0x8EBC6AF09C88C6E3, 0x589965CC75374CC3,
+    };
+    inline constexpr uint64_t HashPrime = 0x9E3779B1;
+
+    // The 128-bit product of a and b with its halves folded together
+    inline uint64_t foldedMultiply(uint64_t a, uint64_t b) {
+      const auto product = static_cast<unsigned __int128>(a) * b;
+      return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+
+    inline uint64_t avalanche(uint64_t x) {
+      x ^= x >> 27;
+      x *= 0x3C79AC492BA7B653;
+      x ^= x >> 33;
+      x *= 0x1C69B3F74AC4AE35;
+      return x ^ (x >> 27);
+    }
+
+    // Every 64 bytes, each of the eight lanes adds the product of the two halves of its word
+    // (mixed with the lane's key) and the plain word from its neighbour. Every 1 KiB the lanes
+    // are scrambled so long inputs don't just add up.
+    inline void hashStripe(std::array<uint64_t, 8>& acc, const char* p) {
+      for (size_t j = 0; j < 8; ++j) {
+        uint64_t v;
+        std::memcpy(&v, p + 8 * j, 8);
+        const uint64_t k = v ^ HashKeys[j];
+        acc[j] += (k & 0xFFFFFFFF) * (k >> 32);
+        acc[j ^ 1] += v;
+      }
+    }
+
+    inline void hashScramble(std::array<uint64_t, 8>& acc) {
+      for (size_t j = 0; j < 8; ++j) acc[j] = (acc[j] ^ (acc[j] >> 47) ^ HashKeys[7 - j]) * HashPrime;
+    }
+
+#if defined(__AVX2__)
+    inline void hashStripes(std::array<uint64_t, 8>& acc, const char* p, size_t stripes) {
+      const auto key0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(HashKeys.data()));
+      const auto key1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(HashKeys.data() + 4));
+      const auto scramble0 = _mm256_setr_epi64x(HashKeys[7], HashKeys[6], HashKeys[5], HashKeys[4]);
+      const auto scramble1 = _mm256_setr_epi64x(HashKeys[3], HashKeys[2], HashKeys[1], HashKeys[0]);
+      const auto prime = _mm256_set1_epi64x(HashPrime);
+      auto acc0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.data()));
+      auto acc1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.data() + 4));
+
+      const auto step = [](__m256i a, __m256i v, __m256i key) {
+        const auto k = _mm256_xor_si256(v, key);
+        const auto product = _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32));
+        // each lane's neighbour is the one it's paired with, 0 with 1 and 2 with 3
+        return _mm256_add_epi64(_mm256_add_epi64(a, product), _mm256_permute4x64_epi64(v, 0b10110001));
+      };
+      const auto scramble = [prime](__m256i a, __m256i key) {
+        a = _mm256_xor_si256(_mm256_xor_si256(a, _mm256_srli_epi64(a, 47)), key);
+        // a 64-bit by 32-bit multiply, from the two halves of a
+        return _mm256_add_epi64(_mm256_mul_epu32(a, prime), _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime), 32));
+      };
+
+      for (size_t s = 0; s < stripes; ++s, p += 64) {
+        acc0 = step(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), key0);
+        acc1 = step(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), key1);
+        if (s % 16 == 15) {
+          acc0 = scramble(acc0, scramble0);
+          acc1 = scramble(acc1, scramble1);
+        }
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc.data()), acc0);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc.data() + 4), acc1);
+    }
+#else
+    inline void hashStripes(std::array<uint64_t, 8>& acc, const char* p, size_t stripes) {
+      for (size_t s = 0; s < stripes; ++s, p += 64) {
+        hashStripe(acc, p);
+        if (s % 16 == 15) hashScramble(acc);
+      }
+    }
+#endif
+  }
+
+  // A 128-bit hash of a buffer, for telling inputs apart rather than for hash tables. Works
+  // through 64 bytes at a time (with AVX2, as two vectors of four lanes), so it runs at
+  // close to memory speed. The vector and scalar paths give the same hash, which matters
+  // since the hashes end up in files.
+  inline hash128_t hashBytes(std::string_view data, uint64_t seed = 0) {
+    using namespace detail;
+    std::array<uint64_t, 8> acc;
+    for (size_t j = 0; j < 8; ++j) acc[j] = HashKeys[j] ^ seed;
+
+    // the whole stripes, then what is left padded out with zeros (the length tells those apart)
+    const size_t stripes = data.size() / 64;
+    hashStripes(acc, data.data(), stripes);
+    if (const size_t tail = data.size() % 64; tail != 0) {
+      char last[64] = {};
+      std::memcpy(last, data.data() + stripes * 64, tail);
+      hashStripe(acc, last);
+    }
+
+    hash128_t result{.lo = data.size() * HashKeys[0], .hi = ~data.size() * HashKeys[1]};
+    for (size_t j = 0; j < 8; j += 2) {
+      result.lo += foldedMultiply(acc[j] ^ HashKeys[7 - j], acc[j + 1] ^ HashKeys[6 - j]);
+      result.hi += foldedMultiply(acc[j] ^ HashKeys[(j + 2) % 8], acc[j + 1] ^ HashKeys[(j + 3) % 8]);
+    }
+    return {.lo = avalanche(result.lo), .hi = avalanche(result.hi ^ seed)};
+  }
+}
@@ -0,0 +1,615 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+// Writers for made up but valid puzzle inputs, so the days can be run on much more than
+// the one real input each. Everything comes from a seed, so the same (day, scale, seed)
+// always gives the same input. What scale counts depends on the day (lines, grid side,
+// rules...), and each day has a base scale about the size of a real input.
+namespace utils::gen {
+  // mt19937_64's output is fixed by the standard, but what the <random> distributions and
+  // std::shuffle make of it isn't, so everything here is drawn straight from the engine
+  // and the inputs come out the same with any standard library.
+  class Rng {
+    public:
+    explicit Rng(uint64_t seed) : engine_(seed) {}
+
+    // Uniform in [lo, hi], rejecting the draws that would favour the low end
+    int64_t between(int64_t lo, int64_t hi) {
+      const uint64_t range = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+      if (range == 0) return static_cast<int64_t>(engine_()); // all of int64_t
+      const uint64_t skip = -range % range; // 2^64 % range
+      uint64_t x;
+      do x = engine_(); while (x < skip);
+      return static_cast<int64_t>(static_cast<uint64_t>(lo) + x % range);
+    }
+    // True with probability p, off the top 53 bits as a double in [0, 1)
+    bool chance(double p) { return static_cast<double>(engine_() >> 11) * 0x1p-53 < p; }
+    char pick(std::string_view from) { return from[between(0, from.size() - 1)]; }
+    // Fisher-Yates
+    template<typename It>
+    void shuffle(It begin, It end) {
+      for (auto i = end - begin - 1; i > 0; --i) std::iter_swap(begin + i, begin + between(0, i));
+    }
+
+    private:
+    std::mt19937_64 engine_;
+  };
+
+  template<typename... Args>
+  void line(std::string& out, fmt::format_string<Args...> format, Args&&... args) {
+    fmt::format_to(std::back_inserter(out), format, std::forward<Args>(args)...);
+    out.push_back('\n');
+  }
+
+  // `id` in the letters of `alphabet`, at least `width` long
+  inline std::string name(size_t id, std::string_view alphabet, size_t width) {
+    std::string result;
+    do {
+      result.push_back(alphabet[id % alphabet.size()]);
+      id /= alphabet.size();
+    } while (id > 0 || result.size() < width);
+    return result;
+  }
+
+  inline bool isPrime(int64_t n) {
+    if (n < 2) return false;
+    for (int64_t d = 2; d * d <= n; ++d) if (n % d == 0) return false;
+    return true;
+  }
+
+  // `count` distinct primes from [lo, hi], or fewer if there aren't that many
+  inline std::vector<int64_t> primesBetween(Rng& rng, int64_t lo, int64_t hi, size_t count) {
+    std::vector<int64_t> primes;
+    for (auto n = lo; n <= hi; ++n) if (isPrime(n)) primes.push_back(n);
+    rng.shuffle(primes.begin(), primes.end());
+    primes.resize(std::min(primes.size(), count));
+    return primes;
+  }
+
+  // Lines of junk with digits and spelt out digits mixed in, always at least one real digit
+  inline std::string day1(Rng& rng, size_t lines) {
+    static constexpr std::array<std::string_view, 9> words = {
+      "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"};
+    std::string out;
+    for (size_t i = 0; i < lines; ++i) {
+      std::string l;
+      const auto pieces = rng.between(2, 10);
+      for (int64_t p = 0; p < pieces; ++p) {
+        if (rng.chance(0.3)) l += words[rng.between(0, 8)];
+        else if (rng.chance(0.3)) l.push_back(rng.pick("123456789"));
+        else l.push_back(rng.pick("abcdefghijklmnopqrstuvwxyz"));
+      }
+      l.insert(rng.between(0, l.size()), 1, rng.pick("123456789"));
+      line(out, "{}", l);
+    }
+    return out;
+  }
+
+  inline std::string day2(Rng& rng, size_t games) {
+    std::string out;
+    for (size_t g = 1; g <= games; ++g) {
+      std::vector<std::string> sets;
+      const auto setCount = rng.between(1, 6);
+      for (int64_t s = 0; s < setCount; ++s) {
+        std::array<std::string_view, 3> colours = {"red", "green", "blue"};
+        rng.shuffle(colours.begin(), colours.end());
+        std::vector<std::string> balls;
+        const auto colourCount = rng.between(1, 3);
+        for (int64_t c = 0; c < colourCount; ++c) balls.push_back(fmt::format("{} {}", rng.between(1, 20), colours[c]));
+        sets.push_back(fmt::format("{}", fmt::join(balls, ", ")));
+      }
+      line(out, "Game {}: {}", g, fmt::join(sets, "; "));
+    }
+    return out;
+  }
+
+  // A side x side schematic of part numbers and symbols
+  inline std::string day3(Rng& rng, size_t side) {
+    std::string out;
+    for (size_t r = 0; r < side; ++r) {
+      std::string l;
+      while (l.size() < side) {
+        const auto room = side - l.size();
+        if (rng.chance(0.12)) {
+          const auto n = fmt::format("{}", rng.between(1, 999));
+          if (n.size() <= room) l += n;
+          if (l.size() < side) l.push_back('.');
+        } else if (rng.chance(0.08)) {
+          l.push_back(rng.chance(0.4) ? '*' : rng.pick("#+$/@=%&-"));
+        } else {
+          l.push_back('.');
+        }
+      }
+      line(out, "{}", l);
+    }
+    return out;
+  }
+
+  // Ten winning numbers and 25 we have per card, like the real thing
+  inline std::string day4(Rng& rng, size_t cards) {
+    const auto idWidth = fmt::format("{}", cards).size();
+    std::vector<int> numbers(99);
+    std::iota(numbers.begin(), numbers.end(), 1);
+    std::string out;
+    for (size_t c = 1; c <= cards; ++c) {
+      rng.shuffle(numbers.begin(), numbers.end());
+      std::vector<int> winners(numbers.begin(), numbers.begin() + 10);
+      rng.shuffle(numbers.begin(), numbers.end());
+      std::vector<int> have(numbers.begin(), numbers.begin() + 25);
+      line(out, "Card {:>{}}: {:>2} | {:>2}", c, idWidth, fmt::join(winners, " "), fmt::join(have, " "));
+    }
+    return out;
+  }
+
+  // Seven maps of `rules` rules each over the 32 bit range, with seed ranges a quarter as
+  // many as the rules and long enough between them to cover most of it. Within a map the
+  // source ranges never overlap, nor do the destinations.
+  inline std::string day5(Rng& rng, size_t rules) {
+    constexpr int64_t span = int64_t{1} << 32;
+    static constexpr std::array<std::string_view, 8> kinds = {
+      "seed", "soil", "fertilizer", "water", "light", "temperature", "humidity", "location"};
+    rules = std::max<size_t>(rules, 1);
+
+    std::string out = "seeds:";
+    const auto ranges = std::max<size_t>(rules / 4, 1);
+    for (size_t i = 0; i < ranges; ++i) {
+      const auto length = rng.between(1, span / ranges);
+      fmt::format_to(std::back_inserter(out), " {} {}", rng.between(0, span - length), length);
+    }
+    out.push_back('\n');
+
+    for (size_t k = 0; k + 1 < kinds.size(); ++k) {
+      line(out, "");
+      line(out, "{}-to-{} map:", kinds[k], kinds[k + 1]);
+      // Cut the range up with a few more pieces than rules, and leave the extras unmapped
+      const auto pieces = rules + rules / 4 + 1;
+      std::set<int64_t> cuts{0, span};
+      while (cuts.size() < pieces + 1) cuts.insert(rng.between(1, span - 1));
+      std::vector<std::pair<int64_t, int64_t>> sources; // start, length
+      for (auto it = cuts.begin(); std::next(it) != cuts.end(); ++it) sources.emplace_back(*it, *std::next(it) - *it);
+      rng.shuffle(sources.begin(), sources.end());
+      sources.resize(rules);
+
+      // Destinations are the same lengths packed together in another order
+      std::vector<size_t> order(rules);
+      std::iota(order.begin(), order.end(), 0);
+      rng.shuffle(order.begin(), order.end());
+      std::vector<int64_t> dests(rules);
+      int64_t next = 0;
+      for (auto i : order) { dests[i] = next; next += sources[i].second; }
+
+      for (size_t i = 0; i < rules; ++i) line(out, "{} {} {}", dests[i], sources[i].first, sources[i].second);
+    }
+    return out;
+  }
+
+  // Part 2 glues every race's numbers together, so past four races they stop fitting in
+  // 64 bits and scale does nothing. Every record can be beaten, joined up or not.
+  inline std::string day6(Rng& rng, size_t) {
+    std::vector<int64_t> times, distances;
+    for (int i = 0; i < 4; ++i) {
+      times.push_back(rng.between(40, 99));
+      distances.push_back(rng.between(100, times.back() * times.back() / 4 - 1));
+    }
+    std::string out;
+    line(out, "Time:     {:>4}", fmt::join(times, "   "));
+    line(out, "Distance: {:>4}", fmt::join(distances, "   "));
+    return out;
+  }
+
+  inline std::string day7(Rng& rng, size_t hands) {
+    std::string out;
+    for (size_t h = 0; h < hands; ++h) {
+      std::string hand;
+      for (int c = 0; c < 5; ++c) hand.push_back(rng.pick("23456789TJQKA"));
+      line(out, "{} {}", hand, rng.between(1, 1000));
+    }
+    return out;
+  }
+
+  // Six ghosts, each on a loop of its own that passes its Z node every n * p steps, where
+  // n is the instruction count and p a small prime. That's the shape the real input has
+  // and what part 2 relies on. Both ways out of a node go on round the loop, so only the
+  // number of instructions matters. Scale is roughly the number of nodes, which are named
+  // with three letters as in the real input, so there's only room for so many.
+  inline std::string day8(Rng& rng, size_t nodes) {
+    constexpr std::string_view letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    constexpr std::string_view inner = "BCDEFGHIJKLMNOPQRSTUVWXY"; // never A or Z, which end the ghosts' names
+    constexpr size_t room = letters.size() * letters.size() * inner.size();
+    const auto periods = primesBetween(rng, 5, 31, 6);
+    const auto total = std::accumulate(periods.begin(), periods.end(), int64_t{0});
+    const auto n = std::max<int64_t>(nodes / total, 1);
+    // every node on a loop but its start and end needs a name of its own
+    if (static_cast<size_t>(n * total) - periods.size() > room)
+      throw std::invalid_argument(fmt::format("day 8 names only have room for about {} nodes", room));
+    const auto nodeName = [&](size_t id) {
+      return std::string{letters[id / inner.size() / letters.size()], letters[id / inner.size() % letters.size()],
+        inner[id % inner.size()]};
+    };
+
+    std::string instructions;
+    for (int64_t i = 0; i < n; ++i) instructions.push_back(rng.pick("LR"));
+
+    std::vector<std::string> lines;
+    size_t next = 0;
+    for (size_t g = 0; g < periods.size(); ++g) {
+      const auto start = g == 0 ? std::string{"AAA"} : name(g, inner, 2) + 'A';
+      const auto end = g == 0 ? std::string{"ZZZ"} : name(g, inner, 2) + 'Z';
+      std::vector<std::string> loop; // what comes after start or end, up to end again
+      for (int64_t i = 1; i < n * periods[g]; ++i) loop.push_back(nodeName(next++));
+      const auto link = [&lines](const std::string& from, const std::string& to) {
+        lines.push_back(fmt::format("{} = ({}, {})", from, to, to));
+      };
+      link(start, loop.front());
+      for (size_t i = 0; i < loop.size(); ++i) link(loop[i], i + 1 < loop.size() ? loop[i + 1] : end);
+      link(end, loop.front());
+    }
+    rng.shuffle(lines.begin(), lines.end());
+
+    std::string out;
+    line(out, "{}", instructions);
+    line(out, "");
+    for (const auto& l : lines) line(out, "{}", l);
+    return out;
+  }
+
+  // Each history is a polynomial of some degree below its length, so the differences
+  // always get down to zeros
+  inline std::string day9(Rng& rng, size_t lines) {
+    constexpr int length = 21;
+    std::string out;
+    for (size_t l = 0; l < lines; ++l) {
+      // coefficients against x choose k, which keeps everything whole
+      std::vector<int64_t> coeffs(rng.between(1, 10));
+      for (auto& c : coeffs) c = rng.between(-10, 10);
+      std::vector<int64_t> values;
+      for (int64_t x = 0; x < length; ++x) {
+        int64_t v = 0, choose = 1;
+        for (int64_t k = 0; k < static_cast<int64_t>(coeffs.size()); ++k) {
+          v += coeffs[k] * choose;
+          choose = choose * (x - k) / (k + 1);
+        }
+        values.push_back(v);
+      }
+      line(out, "{}", fmt::join(values, " "));
+    }
+    return out;
+  }
+
+  // A side x side field of junk pipes with a loop snaking through most of it, starting in
+  // the top left corner so nothing else can touch S
+  inline std::string day10(Rng& rng, size_t side) {
+    side = std::max<size_t>(side, 4);
+    std::vector<std::string> grid(side);
+    for (auto& row : grid) for (size_t c = 0; c < side; ++c) row.push_back(rng.pick("|-LJ7F..."));
+
+    const size_t h = (rng.between(side / 2, side) & ~size_t{1});
+    const size_t w = rng.between(side / 2, side);
+    std::vector<std::pair<size_t, size_t>> loop;
+    for (size_t c = 0; c < w; ++c) loop.emplace_back(0, c);
+    for (size_t r = 1; r < h; ++r) {
+      for (size_t i = 1; i < w; ++i) loop.emplace_back(r, r % 2 ? w - i : i);
+    }
+    for (size_t r = h - 1; r > 0; --r) loop.emplace_back(r, 0);
+
+    for (size_t i = 0; i < loop.size(); ++i) {
+      const auto [r, c] = loop[i];
+      const auto [pr, pc] = loop[(i + loop.size() - 1) % loop.size()];
+      const auto [nr, nc] = loop[(i + 1) % loop.size()];
+      const bool up = pr < r || nr < r, down = pr > r || nr > r;
+      const bool right = pc > c || nc > c, left = pc < c || nc < c;
+      grid[r][c] = up && down ? '|' : left && right ? '-' : up && right ? 'L' : up ? 'J' : left ? '7' : 'F';
+    }
+    grid[0][0] = 'S';
+
+    std::string out;
+    for (const auto& row : grid) line(out, "{}", row);
+    return out;
+  }
+
+  // Sparse galaxies, with one row or column in twenty left empty to be expanded
+  inline std::string day11(Rng& rng, size_t side) {
+    std::vector<bool> emptyCol(side);
+    for (size_t c = 0; c < side; ++c) emptyCol[c] = rng.chance(0.05);
+    std::string out;
+    for (size_t r = 0; r < side; ++r) {
+      const bool emptyRow = rng.chance(0.05);
+      std::string l(side, '.');
+      for (size_t c = 0; c < side; ++c) {
+        if (!emptyRow && !emptyCol[c] && rng.chance(0.02)) l[c] = '#';
+      }
+      line(out, "{}", l);
+    }
+    return out;
+  }
+
+  // Rows made from real arrangements with some springs turned to unknowns
+  inline std::string day12(Rng& rng, size_t lines) {
+    std::string out;
+    for (size_t l = 0; l < lines; ++l) {
+      std::string row;
+      std::vector<int> runs;
+      while (runs.empty()) {
+        row.clear();
+        const auto length = rng.between(5, 20);
+        for (int64_t i = 0; i < length; ++i) row.push_back(rng.chance(0.45) ? '#' : '.');
+        for (size_t i = 0; i < row.size(); ++i) {
+          if (row[i] == '#' && (i == 0 || row[i - 1] == '.')) runs.push_back(0);
+          if (row[i] == '#') ++runs.back();
+        }
+      }
+      for (auto& c : row) if (rng.chance(0.4)) c = '?';
+      line(out, "{} {}", row, fmt::join(runs, ","));
+    }
+    return out;
+  }
+
+  namespace detail {
+    // How many lines of reflection `pattern` has with exactly `smudges` cells off, both ways
+    inline int countReflections(const std::vector<std::string>& pattern, int smudges) {
+      const auto h = pattern.size(), w = pattern[0].size();
+      int result = 0;
+      for (size_t i = 1; i < h; ++i) {
+        int off = 0;
+        for (size_t a = i, b = i - 1; a < h && b < h; ++a, --b)
+          for (size_t c = 0; c < w; ++c) off += pattern[a][c] != pattern[b][c];
+        result += off == smudges;
+      }
+      for (size_t i = 1; i < w; ++i) {
+        int off = 0;
+        for (size_t a = i, b = i - 1; a < w && b < w; ++a, --b)
+          for (size_t r = 0; r < h; ++r) off += pattern[r][a] != pattern[r][b];
+        result += off == smudges;
+      }
+      return result;
+    }
+  }
+
+  // Each pattern has one clean line of reflection and one other that's a single smudge
+  // off. The clean one is planted part way across, and the first two rows differ in one
+  // cell outside it. Anything that turns out to have more than one of either is redone.
+  inline std::string day13(Rng& rng, size_t patterns) {
+    std::string out;
+    for (size_t p = 0; p < patterns; ++p) {
+      if (p > 0) line(out, "");
+      std::vector<std::string> pattern;
+      do {
+        const auto h = rng.between(5, 17), w = rng.between(5, 17);
+        const auto mirror = rng.between(1, (w - 1) / 2); // columns before it are reflected
+        pattern.assign(h, std::string(w, '.'));
+        for (auto& row : pattern) {
+          for (auto& c : row) c = rng.pick(".#");
+          for (int64_t c = 0; c < mirror; ++c) row[2 * mirror - 1 - c] = row[c];
+        }
+        pattern[1] = pattern[0];
+        auto& smudge = pattern[1][rng.between(2 * mirror, w - 1)];
+        smudge = smudge == '.' ? '#' : '.';
+
+        if (rng.chance(0.5)) {
+          std::vector<std::string> transposed(w, std::string(h, '.'));
+          for (int64_t r = 0; r < h; ++r) for (int64_t c = 0; c < w; ++c) transposed[c][r] = pattern[r][c];
+          pattern = std::move(transposed);
+        }
+      } while (detail::countReflections(pattern, 0) != 1 || detail::countReflections(pattern, 1) != 1);
+      for (const auto& row : pattern) line(out, "{}", row);
+    }
+    return out;
+  }
+
+  inline std::string day14(Rng& rng, size_t side) {
+    std::string out;
+    for (size_t r = 0; r < side; ++r) {
+      std::string l(side, '.');
+      for (auto& c : l) c = rng.chance(0.2) ? 'O' : rng.chance(0.2) ? '#' : '.';
+      line(out, "{}", l);
+    }
+    return out;
+  }
+
+  // Steps drawn from a pool of labels so lenses do get replaced and removed
+  inline std::string day15(Rng& rng, size_t steps) {
+    std::vector<std::string> labels(std::max<size_t>(steps / 4, 1));
+    for (auto& l : labels) {
+      const auto length = rng.between(2, 6);
+      for (int64_t i = 0; i < length; ++i) l.push_back(rng.pick("abcdefghijklmnopqrstuvwxyz"));
+    }
+    std::vector<std::string> sequence;
+    for (size_t s = 0; s < steps; ++s) {
+      const auto& label = labels[rng.between(0, labels.size() - 1)];
+      sequence.push_back(rng.chance(0.3) ? label + '-' : fmt::format("{}={}", label, rng.between(1, 9)));
+    }
+    std::string out;
+    line(out, "{}", fmt::join(sequence, ","));
+    return out;
+  }
+
+  inline std::string day16(Rng& rng, size_t side) {
+    std::string out;
+    for (size_t r = 0; r < side; ++r) {
+      std::string l(side, '.');
+      for (auto& c : l) if (rng.chance(0.1)) c = rng.pick("/\\|-");
+      line(out, "{}", l);
+    }
+    return out;
+  }
+
+  inline std::string day17(Rng& rng, size_t side) {
+    std::string out;
+    for (size_t r = 0; r < side; ++r) {
+      std::string l(side, '1');
+      for (auto& c : l) c = rng.pick("123456789");
+      line(out, "{}", l);
+    }
+    return out;
+  }
+
+  // A lagoon bounded by a skyline on top and an upside down one below, so it never
+  // crosses itself. Part 1 and part 2 dig different ones with the same number of steps,
+  // the second much bigger. Scale is the number of steps.
+  inline std::string day18(Rng& rng, size_t steps) {
+    const auto columns = std::max<size_t>(steps / 4, 2);
+    const auto dig = [&](int64_t most) {
+      const auto heights = [&] {
+        std::vector<int64_t> result;
+        while (result.size() < columns) {
+          const auto h = rng.between(1, most);
+          if (result.empty() || h != result.back()) result.push_back(h);
+        }
+        return result;
+      };
+      const auto top = heights(), bottom = heights();
+      std::vector<std::pair<char, int64_t>> result;
+      const auto vertical = [&](int64_t delta) { result.emplace_back(delta > 0 ? 'U' : 'D', std::abs(delta)); };
+      std::vector<int64_t> widths(columns);
+      for (auto& w : widths) w = rng.between(1, most);
+
+      vertical(top[0]);
+      for (size_t i = 0; i < columns; ++i) {
+        result.emplace_back('R', widths[i]);
+        if (i + 1 < columns) vertical(top[i + 1] - top[i]);
+      }
+      vertical(-top.back() - bottom.back());
+      for (size_t i = columns; i-- > 0;) {
+        result.emplace_back('L', widths[i]);
+        if (i > 0) vertical(bottom[i] - bottom[i - 1]);
+      }
+      vertical(bottom[0]);
+      return result;
+    };
+    const auto small = dig(10), big = dig(0x7FFFF);
+
+    std::string out;
+    for (size_t i = 0; i < small.size(); ++i) {
+      const auto code = std::string_view{"RDLU"}.find(big[i].first);
+      line(out, "{} {} (#{:05x}{})", small[i].first, small[i].second, big[i].second, code);
+    }
+    return out;
+  }
+
+  // `workflows` workflows in a tree under "in", about half of them hanging off the one
+  // made just before so it gets deep, followed by as many parts
+  inline std::string day19(Rng& rng, size_t workflows) {
+    constexpr std::string_view letters = "abcdefghijklmnopqrstuvwxyz";
+    workflows = std::max<size_t>(workflows, 1);
+    std::vector<std::vector<size_t>> children(workflows);
+    for (size_t w = 1; w < workflows; ++w) {
+      auto parent = rng.chance(0.5) ? w - 1 : rng.between(0, w - 1);
+      if (children[parent].size() >= 3) parent = w - 1;
+      children[parent].push_back(w);
+    }
+    // other names are three letters or more, so can't be "in"
+    const auto wfName = [&](size_t w) { return w == 0 ? std::string{"in"} : name(w, letters, 3); };
+    const auto condition = [&] {
+      return fmt::format("{}{}{}", rng.pick("xmas"), rng.pick("<>"), rng.between(1, 4000));
+    };
+
+    std::vector<std::string> lines;
+    for (size_t w = 0; w < workflows; ++w) {
+      std::vector<std::string> rules;
+      for (auto child : children[w]) rules.push_back(fmt::format("{}:{}", condition(), wfName(child)));
+      const auto extra = rng.between(rules.empty() ? 1 : 0, 2);
+      for (int64_t i = 0; i < extra; ++i) rules.push_back(fmt::format("{}:{}", condition(), rng.pick("AR")));
+      rng.shuffle(rules.begin(), rules.end());
+      rules.push_back(std::string(1, rng.pick("AR")));
+      lines.push_back(fmt::format("{}{{{}}}", wfName(w), fmt::join(rules, ",")));
+    }
+    rng.shuffle(lines.begin(), lines.end());
+
+    std::string out;
+    for (const auto& l : lines) line(out, "{}", l);
+    line(out, "");
+    for (size_t p = 0; p < workflows; ++p) {
+      line(out, "{{x={},m={},a={},s={}}}", rng.between(1, 4000), rng.between(1, 4000),
+          rng.between(1, 4000), rng.between(1, 4000));
+    }
+    return out;
+  }
+
+  // Four binary counters of flip-flops off the broadcaster. Each one's conjunction hears
+  // from the bits set in its period and, once they're all on, sets the rest and carries
+  // so the counter wraps to zero, while telling rm through an inverter. Part 2 takes the
+  // product of the periods, which are primes between scale/2 and scale (so at most 32767
+  // to keep the product in 64 bits).
+  inline std::string day20(Rng& rng, size_t scale) {
+    const auto most = std::clamp<int64_t>(scale, 64, 32767);
+    const auto periods = primesBetween(rng, most / 2 + 1, most, 4);
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 26 * 26; ++i) {
+      auto n = name(i, "abcdefghijklmnopqrstuvwxyz", 2);
+      if (n != "rm" && n != "rx") names.push_back(std::move(n));
+    }
+    rng.shuffle(names.begin(), names.end());
+    size_t nextName = 0;
+
+    std::vector<std::string> lines, firsts;
+    for (const auto period : periods) {
+      const int bits = std::bit_width(static_cast<uint64_t>(period));
+      std::vector<std::string> flops;
+      for (int b = 0; b < bits; ++b) flops.push_back(names[nextName++]);
+      const auto hub = names[nextName++];
+      const auto inverter = names[nextName++];
+      firsts.push_back(flops[0]);
+
+      std::vector<std::string> hubOutputs{flops[0], inverter};
+      for (int b = 0; b < bits; ++b) {
+        std::vector<std::string> outputs;
+        if (b + 1 < bits) outputs.push_back(flops[b + 1]);
+        if (period >> b & 1) outputs.push_back(hub);
+        else hubOutputs.push_back(flops[b]);
+        rng.shuffle(outputs.begin(), outputs.end());
+        lines.push_back(fmt::format("%{} -> {}", flops[b], fmt::join(outputs, ", ")));
+      }
+      rng.shuffle(hubOutputs.begin(), hubOutputs.end());
+      lines.push_back(fmt::format("&{} -> {}", hub, fmt::join(hubOutputs, ", ")));
+      lines.push_back(fmt::format("&{} -> rm", inverter));
+    }
+    lines.push_back(fmt::format("broadcaster -> {}", fmt::join(firsts, ", ")));
+    lines.push_back("&rm -> rx");
+    rng.shuffle(lines.begin(), lines.end());
+
+    std::string out;
+    for (const auto& l : lines) line(out, "{}", l);
+    return out;
+  }
+
+  struct generator_t {
+    std::string (*generate)(Rng&, size_t);
+    size_t base;        // about the size of a real input
+    bool scales = true; // false if scale is ignored
+  };
+
+  inline const std::array<generator_t, 20>& generators() {
+    static const std::array<generator_t, 20> table = {{
+      {day1, 1000},  {day2, 100},   {day3, 140},   {day4, 200},  {day5, 40},
+      {day6, 4, false}, {day7, 1000}, {day8, 750}, {day9, 200}, {day10, 140},
+      {day11, 140},  {day12, 1000}, {day13, 100},  {day14, 100}, {day15, 4000},
+      {day16, 110},  {day17, 141},  {day18, 700},  {day19, 550}, {day20, 4096},
+    }};
+    return table;
+  }
+}
+
+namespace utils {
+  // An input for `day` at `scale` (0 for that day's base scale) from `seed`
+  inline std::string generateInput(int day, size_t scale = 0, uint64_t seed = 0) {
+    if (day < 1 || day > 20) throw std::invalid_argument(fmt::format("no generator for day {}", day));
+    const auto& g = gen::generators()[day - 1];
+    gen::Rng rng{seed};
+    return g.generate(rng, scale ? scale : g.base);
+  }
+}
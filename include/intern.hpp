@@ -0,0 +1,175 @@
+#pragma once
+
+#include "hash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <immintrin.h>
+
+namespace utils {
+  namespace detail {
+    // Cheap enough for the 2-5 character names puzzles use, which would spend longer
+    // setting up hashBytes than hashing. Up to 16 bytes is two overlapping loads.
+    inline uint64_t hashKey(std::string_view key) {
+      const auto* p = key.data();
+      const size_t n = key.size();
+      uint64_t a = 0, b = 0;
+      if (n > 16) {
+        return hashBytes(key).lo;
+      } else if (n >= 8) {
+        std::memcpy(&a, p, 8);
+        std::memcpy(&b, p + n - 8, 8);
+      } else if (n >= 4) {
+        uint32_t x, y;
+        std::memcpy(&x, p, 4);
+        std::memcpy(&y, p + n - 4, 4);
+        a = x;
+        b = y;
+      } else if (n > 0) {
+        a = uint64_t{static_cast<uint8_t>(p[0])} | uint64_t{static_cast<uint8_t>(p[n / 2])} << 8 |
+            uint64_t{static_cast<uint8_t>(p[n - 1])} << 16;
+      }
+      return foldedMultiply(a ^ HashKeys[0], b ^ HashKeys[1] ^ n);
+    }
+  }
+
+  // Gives each distinct name a dense id, 0 for the first one seen, 1 for the next and so on,
+  // so a day can keep its nodes in vectors indexed by id rather than in maps keyed by
+  // strings.
+  //
+  // The table is open addressing in groups of 16 slots, each with a control byte holding 7
+  // bits of its key's hash (or Empty). A lookup compares a whole group's control bytes at
+  // once with SSE2 and only looks at the slots whose bits match. Keys short enough to fit go
+  // in the slot itself, so most lookups never leave the table. Every name is also kept one
+  // after the other by id, which is where longer keys are compared against and what name()
+  // hands back, so lookups can be made with string_views into input that's since gone.
+  class InternTable {
+    public:
+    static constexpr size_t GroupSize = 16;
+    static constexpr size_t InlineKey = 11;
+
+    explicit InternTable(size_t expected = 0) { resize(groupsFor(expected)); }
+
+    // Forgets every name but keeps the memory, with room for at least `expected` more
+    void clear(size_t expected = 0) {
+      names_.clear();
+      ends_.clear();
+      resize(std::max(groups(), groupsFor(expected)));
+    }
+
+    // The id of key, giving it the next one if it hasn't been seen before
+    uint32_t intern(std::string_view key) {
+      const auto hash = detail::hashKey(key);
+      if (const auto found = find(key, hash)) return *found;
+      if ((ends_.size() + 1) * 8 > slots_.size() * 7) resize(groups() * 2);
+
+      const uint32_t id = ends_.size();
+      names_.insert(names_.end(), key.begin(), key.end());
+      ends_.push_back(names_.size());
+      place(id, key, hash);
+      return id;
+    }
+
+    std::optional<uint32_t> find(std::string_view key) const { return find(key, detail::hashKey(key)); }
+
+    std::string_view name(uint32_t id) const {
+      const auto first = id == 0 ? 0 : ends_[id - 1];
+      return {names_.data() + first, ends_[id] - first};
+    }
+    size_t size() const { return ends_.size(); }
+
+    // Every name one after the other in id order, and where each one ends
+    const std::vector<char>& names() const { return names_; }
+    const std::vector<uint32_t>& nameEnds() const { return ends_; }
+
+    private:
+    static constexpr uint8_t Empty = 0x80;
+
+    struct slot_t {
+      uint32_t id;
+      uint8_t length; // of the key, up to 255
+      char key[InlineKey];
+    };
+    static_assert(sizeof(slot_t) == 16);
+
+    size_t groups() const { return slots_.size() / GroupSize; }
+    static size_t groupsFor(size_t expected) {
+      size_t groups = 1;
+      while (groups * GroupSize * 7 / 8 < expected) groups *= 2;
+      return groups;
+    }
+
+    // Groups are visited 1, 2, 3... apart, which with a power of two of them reaches them all
+    template<typename Visit>
+    void probe(uint64_t hash, Visit visit) const {
+      const size_t mask = groups() - 1;
+      for (size_t group = (hash >> 7) & mask, step = 1; !visit(group * GroupSize); group = (group + step++) & mask) {}
+    }
+
+    // Bitmask of which control bytes in the group at ctrl are byte
+    static uint32_t matchByte(const uint8_t* ctrl, uint8_t byte) {
+#if defined(__SSE2__)
+      const auto group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+      return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(byte))));
+#else
+      uint32_t result = 0;
+      for (size_t i = 0; i < GroupSize; ++i) result |= uint32_t{ctrl[i] == byte} << i;
+      return result;
+#endif
+    }
+
+    bool matches(const slot_t& slot, std::string_view key) const {
+      if (slot.length != std::min<size_t>(key.size(), 255)) return false;
+      if (key.size() <= InlineKey) return std::memcmp(slot.key, key.data(), key.size()) == 0;
+      return name(slot.id) == key;
+    }
+
+    std::optional<uint32_t> find(std::string_view key, uint64_t hash) const {
+      const auto tag = static_cast<uint8_t>(hash & 0x7F);
+      std::optional<uint32_t> result;
+      // nothing is ever removed, so a group with room in it ends the search
+      probe(hash, [&](size_t first) {
+        for (auto found = matchByte(&ctrl_[first], tag); found; found &= found - 1) {
+          const auto& slot = slots_[first + std::countr_zero(found)];
+          if (matches(slot, key)) {
+            result = slot.id;
+            return true;
+          }
+        }
+        return matchByte(&ctrl_[first], Empty) != 0;
+      });
+      return result;
+    }
+
+    void place(uint32_t id, std::string_view key, uint64_t hash) {
+      probe(hash, [&](size_t first) {
+        const auto empty = matchByte(&ctrl_[first], Empty);
+        if (!empty) return false;
+        const size_t at = first + std::countr_zero(empty);
+        ctrl_[at] = static_cast<uint8_t>(hash & 0x7F);
+        auto& slot = slots_[at];
+        slot.id = id;
+        slot.length = std::min<size_t>(key.size(), 255);
+        if (key.size() <= InlineKey) std::memcpy(slot.key, key.data(), key.size());
+        return true;
+      });
+    }
+
+    void resize(size_t groups) {
+      ctrl_.assign(groups * GroupSize, Empty);
+      slots_.assign(groups * GroupSize, slot_t{});
+      for (uint32_t id = 0; id < ends_.size(); ++id) place(id, name(id), detail::hashKey(name(id)));
+    }
+
+    std::vector<uint8_t> ctrl_;
+    std::vector<slot_t> slots_;
+    std::vector<char> names_;
+    std::vector<uint32_t> ends_;
+  };
+}
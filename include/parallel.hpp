@@ -0,0 +1,280 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+#include "utils.hpp"
+
+namespace utils {
+  // Worker threads that each keep their own deque of tasks. A worker takes the newest task
+  // off its own deque, and when that's empty steals the oldest from someone else's (or from
+  // the queue that tasks submitted from outside the pool go on). Anything waiting on tasks
+  // from the pool (TaskGroup::wait) runs them itself in the meantime, so parallel code can
+  // be nested without tying every thread up in waiting.
+  //
+  // A pool of no threads runs everything inline as it's submitted, which is the sequential
+  // path to compare against.
+  class ThreadPool {
+    public:
+    using task_t = std::move_only_function<void()>;
+
+    explicit ThreadPool(size_t threads = defaultThreads()) : queues_(threads + 1) {
+      for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i](std::stop_token st) { work(st, i); });
+      }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+      for (auto& w : workers_) w.request_stop();
+      {
+        std::lock_guard lock{sleep_mutex_};
+      }
+      cv_.notify_all();
+      workers_.clear();
+    }
+
+    // Queues a task, on this thread's own deque if it's one of the workers
+    void spawn(task_t task) {
+      if (workers_.empty()) return task();
+      auto& queue = queues_[current_ && current_->pool == this ? current_->index : workers_.size()];
+      // Counted before it's visible, so a thread that takes it straight away can't take
+      // pending_ below zero
+      {
+        std::lock_guard lock{sleep_mutex_};
+        ++pending_;
+      }
+      {
+        std::lock_guard lock{queue.mutex};
+        queue.tasks.push_back(std::move(task));
+      }
+      cv_.notify_one();
+    }
+
+    template<typename F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+      std::packaged_task<std::invoke_result_t<F>()> task{std::forward<F>(f)};
+      auto result = task.get_future();
+      spawn(std::move(task));
+      return result;
+    }
+
+    // Runs one queued task on the calling thread, if there is one
+    bool runOne() {
+      const auto own = current_ && current_->pool == this ? current_->index : workers_.size();
+      if (auto task = take(own)) {
+        (*task)();
+        return true;
+      }
+      return false;
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    static size_t defaultThreads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+    // How many threads global() gets, which can be changed until it's first used
+    static size_t& globalThreads() {
+      static size_t threads = defaultThreads();
+      return threads;
+    }
+
+    static ThreadPool& global() {
+      static ThreadPool pool{globalThreads()};
+      return pool;
+    }
+
+    private:
+    struct queue_t {
+      std::mutex mutex;
+      std::deque<task_t> tasks;
+    };
+
+    struct worker_t {
+      ThreadPool* pool;
+      size_t index;
+    };
+    static inline thread_local const worker_t* current_ = nullptr;
+
+    // Our own newest task, or else the oldest one anyone else has
+    std::optional<task_t> take(size_t own) {
+      const auto popped = [this](std::optional<task_t> task) {
+        pending_.fetch_sub(1);
+        return task;
+      };
+      if (own < workers_.size()) {
+        auto& queue = queues_[own];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+          auto task = std::move(queue.tasks.back());
+          queue.tasks.pop_back();
+          return popped(std::move(task));
+        }
+      }
+      for (size_t i = 1; i <= queues_.size(); ++i) {
+        auto& queue = queues_[(own + i) % queues_.size()];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+          auto task = std::move(queue.tasks.front());
+          queue.tasks.pop_front();
+          return popped(std::move(task));
+        }
+      }
+      return std::nullopt;
+    }
+
+    void work(std::stop_token st, size_t index) {
+      const worker_t self{this, index};
+      current_ = &self;
+      while (true) {
+        if (auto task = take(index)) {
+          (*task)();
+          continue;
+        }
+        std::unique_lock lock{sleep_mutex_};
+        if (!cv_.wait(lock, st, [this] { return pending_ > 0; })) return;
+      }
+    }
+
+    std::vector<queue_t> queues_; // one per worker, then one for everyone else
+    std::atomic<size_t> pending_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable_any cv_;
+    std::vector<std::jthread> workers_; // last, so they're joined before the queues go away
+  };
+
+  // Tasks spawned onto a pool that can be waited on together. The first exception any of
+  // them throws comes back out of wait().
+  class TaskGroup {
+    public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::global()) : pool_(pool) {}
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    ~TaskGroup() {
+      while (outstanding_ > 0) helpOrYield();
+    }
+
+    template<typename F>
+    void spawn(F f) {
+      ++outstanding_;
+      pool_.spawn([this, f = std::move(f)]() mutable {
+        try {
+          f();
+        } catch (...) {
+          std::lock_guard lock{error_mutex_};
+          if (!error_) error_ = std::current_exception();
+        }
+        --outstanding_;
+      });
+    }
+
+    void wait() {
+      while (outstanding_ > 0) helpOrYield();
+      if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+
+    private:
+    void helpOrYield() {
+      if (!pool_.runOne()) std::this_thread::yield();
+    }
+
+    ThreadPool& pool_;
+    std::atomic<size_t> outstanding_ = 0;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+  };
+
+  // Splits [begin, end) into about `chunks` runs (four per thread by default) of at least
+  // `grain` each
+  inline std::vector<std::pair<size_t, size_t>> splitRange(size_t begin, size_t end, const ThreadPool& pool,
+      size_t grain, size_t chunks) {
+    if (chunks == 0) chunks = std::max<size_t>(pool.size(), 1) * 4;
+    const size_t n = end > begin ? end - begin : 0;
+    const size_t size = std::max({grain, size_t{1}, (n + chunks - 1) / chunks});
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t at = begin; at < end; at += size) runs.emplace_back(at, std::min(end, at + size));
+    return runs;
+  }
+
+  // Calls f(i) for every i in [begin, end) across the pool, and returns once they're all done
+  template<typename F>
+  void parallelFor(size_t begin, size_t end, F f, ThreadPool& pool = ThreadPool::global(), size_t grain = 1) {
+    TaskGroup group{pool};
+    for (auto [from, to] : splitRange(begin, end, pool, grain, 0)) {
+      group.spawn([from, to, &f] { for (size_t i = from; i < to; ++i) f(i); });
+    }
+    group.wait();
+  }
+
+  // Folds [begin, end) in runs across the pool, each into its own copy of `init` with
+  // fold(acc, i), and then combines the runs' results in order with combine(lhs, rhs)
+  template<typename T, typename F, typename C>
+  T parallelReduce(size_t begin, size_t end, T init, F fold, C combine,
+      ThreadPool& pool = ThreadPool::global(), size_t grain = 1) {
+    const auto runs = splitRange(begin, end, pool, grain, 0);
+    std::vector<std::optional<T>> results(runs.size());
+    TaskGroup group{pool};
+    for (size_t r = 0; r < runs.size(); ++r) {
+      group.spawn([&result = results[r], run = runs[r], &init, &fold] {
+        T acc = init;
+        for (size_t i = run.first; i < run.second; ++i) fold(acc, i);
+        result.emplace(std::move(acc));
+      });
+    }
+    group.wait();
+
+    if (results.empty()) return init;
+    T result = std::move(*results.front());
+    for (size_t i = 1; i < results.size(); ++i) result = combine(std::move(result), std::move(*results[i]));
+    return result;
+  }
+
+  // Splits buf into `shards` pieces ending on newlines, folds the lines of each piece
+  // into its own copy of `init` with onLine(acc, line) on the pool, and then combines the
+  // per-shard results in input order with combine(lhs, rhs).
+  template<typename T, typename F, typename C>
+  T reduceLines(std::string_view buf, T init, F onLine, C combine,
+      ThreadPool& pool = ThreadPool::global(), size_t shards = 0) {
+    if (shards == 0) shards = std::max<size_t>(pool.size(), 1);
+
+    std::vector<std::string_view> pieces;
+    size_t start = 0;
+    for (size_t i = 1; i <= shards && start < buf.size(); ++i) {
+      size_t end = buf.size();
+      if (i < shards) {
+        end = std::max(start, buf.size() * i / shards);
+        end = std::min(buf.find('\n', end), buf.size()) + 1;
+        end = std::min(end, buf.size());
+      }
+      pieces.push_back(buf.substr(start, end - start));
+      start = end;
+    }
+
+    std::vector<std::optional<T>> results(pieces.size());
+    TaskGroup group{pool};
+    for (size_t i = 0; i < pieces.size(); ++i) {
+      group.spawn([piece = pieces[i], &result = results[i], &init, &onLine]() mutable {
+        TraceScope trace{"shard of {} bytes", piece.size()};
+        T acc = init;
+        while (auto line = getLine(piece)) onLine(acc, *line);
+        result.emplace(std::move(acc));
+      });
+    }
+    group.wait();
+
+    if (results.empty()) return init;
+    T result = std::move(*results.front());
+    for (size_t i = 1; i < results.size(); ++i) result = combine(std::move(result), std::move(*results[i]));
+    return result;
+  }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace utils {
+  // Hardware counts over a region. Any the kernel wouldn't give us are left empty.
+  struct perf_sample_t {
+    std::optional<uint64_t> cycles;
+    std::optional<uint64_t> instructions;
+    std::optional<uint64_t> branches;
+    std::optional<uint64_t> branch_misses;
+    std::optional<uint64_t> l1d_misses; // data reads that missed L1
+    std::optional<uint64_t> llc_misses;
+
+    std::optional<double> ipc() const { return ratio(instructions, cycles); }
+    // per thousand instructions
+    std::optional<double> l1dMpki() const { return perKilo(l1d_misses); }
+    std::optional<double> llcMpki() const { return perKilo(llc_misses); }
+    std::optional<double> branchMissRate() const { return ratio(branch_misses, branches); }
+
+    std::string summary() const {
+      const auto show = [](std::optional<double> v, std::string_view format) {
+        return v ? fmt::format(fmt::runtime(format), *v) : std::string{"n/a"};
+      };
+      return fmt::format("IPC {}, L1d misses {}, LLC misses {}, branch misses {}",
+          show(ipc(), "{:.2f}"), show(l1dMpki(), "{:.2f}/ki"), show(llcMpki(), "{:.3f}/ki"),
+          show(branchMissRate().transform([](double r) { return r * 100; }), "{:.2f}%"));
+    }
+
+    private:
+    static std::optional<double> ratio(std::optional<uint64_t> n, std::optional<uint64_t> d) {
+      if (!n || !d || *d == 0) return std::nullopt;
+      return static_cast<double>(*n) / *d;
+    }
+    std::optional<double> perKilo(std::optional<uint64_t> n) const {
+      return ratio(n, instructions).transform([](double r) { return r * 1000; });
+    }
+  };
+
+  // A set of perf_event_open counters for the calling thread (and any threads it starts
+  // while they're running, but not ones that already exist, such as the global pool's).
+  // Each is opened on its own rather than as a group, so one the PMU can't fit just gets
+  // multiplexed and scaled up instead of stopping the rest. If perf isn't permitted,
+  // say with a high kernel.perf_event_paranoid or in a container, they all stay closed
+  // and the samples come back empty.
+  class PerfCounters {
+    public:
+    PerfCounters() {
+      const auto cache = [](uint64_t which, uint64_t op, uint64_t result) { return which | (op << 8) | (result << 16); };
+      const std::array<std::pair<uint32_t, uint64_t>, Events> events = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      }};
+      for (size_t i = 0; i < Events; ++i) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = events[i].first;
+        attr.config = events[i].second;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds_[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+      }
+    }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters() {
+      for (auto fd : fds_) if (fd >= 0) close(fd);
+    }
+
+    bool available() const {
+      return std::any_of(fds_.begin(), fds_.end(), [](int fd) { return fd >= 0; });
+    }
+
+    void start() {
+      for (auto fd : fds_) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+
+    perf_sample_t stop() {
+      for (auto fd : fds_) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      return {
+        .cycles = read(0), .instructions = read(1), .branches = read(2),
+        .branch_misses = read(3), .l1d_misses = read(4), .llc_misses = read(5),
+      };
+    }
+
+    private:
+    static constexpr size_t Events = 6;
+
+    // Scaled up by how much of the time it was actually on the PMU
+    std::optional<uint64_t> read(size_t i) const {
+      if (fds_[i] < 0) return std::nullopt;
+      struct { uint64_t value, enabled, running; } r;
+      if (::read(fds_[i], &r, sizeof(r)) != sizeof(r) || r.running == 0) return std::nullopt;
+      return static_cast<uint64_t>(static_cast<double>(r.value) * r.enabled / r.running);
+    }
+
+    std::array<int, Events> fds_;
+  };
+
+  // Counts the scope it's in into `out`
+  class PerfScope {
+    public:
+    PerfScope(PerfCounters& counters, perf_sample_t& out) : counters_(counters), out_(out) { counters_.start(); }
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+    ~PerfScope() { out_ = counters_.stop(); }
+
+    private:
+    PerfCounters& counters_;
+    perf_sample_t& out_;
+  };
+}
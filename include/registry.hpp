@@ -0,0 +1,172 @@
+#pragma once
+
+#include "hash.hpp"
+#include "snapshot.hpp"
+
+#include <any>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include <fmt/format.h>
+
+namespace utils {
+  // A day's entry points with the types erased, so one driver can run any of them. parse
+  // gets the whole input and whatever it returns is handed to both parts, which must
+  // leave it as they found it.
+  struct Day {
+    int number;
+    std::function<std::any(std::string_view)> parse;
+    std::function<std::string(const std::any&)> part1;
+    std::function<std::string(const std::any&)> part2; // empty for days without one
+    std::function<void()> test;
+    int cost; // rough relative run time on a real input, for scheduling
+
+    // For days that can write what parse returns to a snapshot and map it back in later,
+    // empty otherwise. layout is the day's version of what it puts in the snapshot.
+    std::function<void(const std::any&, SnapshotWriter&)> save;
+    std::function<std::any(std::shared_ptr<const Snapshot>)> load;
+    uint32_t layout = 0;
+
+    // For days that can parse into what they parsed last time, keeping its buffers, empty
+    // otherwise. Returns the same as parse, and leaves what to reuse in scratch, which
+    // starts out empty and is only ever handed back to the same day.
+    std::function<std::any(std::string_view, std::any& scratch)> reparse;
+
+    std::string defaultInput() const { return fmt::format("inp/day{}.txt", number); }
+  };
+
+  // Both of a day's answers as its parts return them. Days without a second part have
+  // std::monostate there.
+  template<typename Part1, typename Part2 = std::monostate>
+  struct Answers {
+    Part1 part1;
+    Part2 part2;
+    bool operator==(const Answers&) const = default;
+  };
+
+  // Every day linked into the binary, by number
+  inline std::map<int, Day>& days() {
+    static std::map<int, Day> registry;
+    return registry;
+  }
+
+  namespace detail {
+    // std::any wants something copyable, and the parsed input often holds views into
+    // itself, so it's built in place once and shared instead
+    template<typename Parse>
+    using parsed_t = std::invoke_result_t<Parse, std::string_view>;
+
+    template<typename Parse>
+    std::any parseInto(const Parse& parse, std::string_view input) {
+      return std::shared_ptr<const parsed_t<Parse>>(new parsed_t<Parse>(parse(input)));
+    }
+
+    template<typename Parse, typename Part>
+    std::function<std::string(const std::any&)> erasePart(Part part) {
+      return [part](const std::any& parsed) {
+        const auto& input = *std::any_cast<const std::shared_ptr<const parsed_t<Parse>>&>(parsed);
+        return fmt::format("{}", part(input));
+      };
+    }
+  }
+
+  // Adds a day to days(). Meant for initializing a namespace scope variable in the day's
+  // own file, so linking the file in is all it takes to make the day available.
+  template<typename Parse, typename Part1, typename Part2>
+  bool registerDay(int number, Parse parse, Part1 part1, Part2 part2, void (*test)() = nullptr, int cost = 1) {
+    Day day{
+      .number = number,
+      .parse = [parse](std::string_view input) { return detail::parseInto(parse, input); },
+      .part1 = detail::erasePart<Parse>(part1),
+      .part2 = {},
+      .test = test,
+      .cost = cost,
+      .save = {},
+      .load = {},
+      .layout = 0,
+      .reparse = {},
+    };
+    if constexpr (!std::is_null_pointer_v<Part2>) day.part2 = detail::erasePart<Parse>(part2);
+    return days().emplace(number, std::move(day)).second;
+  }
+
+  // Lets a day already in days() write and load snapshots of its parsed input, with
+  // save(parsed, writer) and load(snapshot) returning the same type as parse. Meant for the
+  // day's own file, next to registerDay.
+  template<typename Parse, typename Save, typename Load>
+  bool registerSnapshot(int number, uint32_t layout, Parse, Save save, Load load) {
+    auto& day = days().at(number);
+    day.layout = layout;
+    day.save = [save](const std::any& parsed, SnapshotWriter& writer) {
+      save(*std::any_cast<const std::shared_ptr<const detail::parsed_t<Parse>>&>(parsed), writer);
+    };
+    day.load = [load](std::shared_ptr<const Snapshot> snapshot) -> std::any {
+      return std::shared_ptr<const detail::parsed_t<Parse>>(new detail::parsed_t<Parse>(load(std::move(snapshot))));
+    };
+    return true;
+  }
+
+  // Lets a day already in days() reuse what it parsed for the last input on the next one,
+  // with parseInto(input, out) leaving out as parse(input) would return it, though with
+  // whatever capacity it had before. Meant for the day's own file, next to registerDay.
+  template<typename Parse, typename ParseInto>
+  bool registerReparse(int number, Parse, ParseInto parseInto) {
+    using parsed_t = detail::parsed_t<Parse>;
+    days().at(number).reparse = [parseInto](std::string_view input, std::any& scratch) -> std::any {
+      auto* reused = std::any_cast<std::shared_ptr<parsed_t>>(&scratch);
+      // whatever was parsed last has to have been let go of before it can be written over
+      if (!reused || reused->use_count() > 1) {
+        scratch = std::make_shared<parsed_t>();
+        reused = std::any_cast<std::shared_ptr<parsed_t>>(&scratch);
+      }
+      parseInto(input, **reused);
+      return std::shared_ptr<const parsed_t>(*reused);
+    };
+    return true;
+  }
+
+  // For a parseInto whose parsed form points into a block of storage (as days with
+  // snapshots do): the block it filled in last time, if nothing else holds it, or else a
+  // new one. Only what parseInto made itself ever comes back to it, never a snapshot.
+  template<typename Storage>
+  std::shared_ptr<Storage> reuseStorage(const std::shared_ptr<const void>& storage) {
+    if (storage.use_count() != 1) return std::make_shared<Storage>();
+    return std::const_pointer_cast<Storage>(std::static_pointer_cast<const Storage>(storage));
+  }
+
+  inline void saveSnapshot(const Day& day, const std::any& parsed, hash128_t input, const std::string& path) {
+    if (!day.save) throw std::invalid_argument(fmt::format("day {} can't write snapshots", day.number));
+    SnapshotWriter writer;
+    day.save(parsed, writer);
+    writer.write(path, day.number, day.layout, input);
+  }
+
+  // What parse would have returned for the text the snapshot was written from
+  inline std::any loadSnapshot(const Day& day, const std::string& path) {
+    if (!day.load) throw std::invalid_argument(fmt::format("day {} can't load snapshots", day.number));
+    auto snapshot = Snapshot::open(path);
+    if (snapshot->day() != day.number || snapshot->layout() != day.layout)
+      throw std::runtime_error(fmt::format("{} is a snapshot for day {} layout {}, not day {} layout {}",
+          path, snapshot->day(), snapshot->layout(), day.number, day.layout));
+    return day.load(std::move(snapshot));
+  }
+
+  // Parses the input and runs both parts on it, for a day's typed solve(). Nothing goes
+  // through std::any or strings, so it's as cheap to call in a loop as the parts themselves.
+  template<typename Parse, typename Part1, typename Part2>
+  auto solveWith(std::string_view input, Parse parse, Part1 part1, Part2 part2) {
+    const detail::parsed_t<Parse> parsed = parse(input);
+    using answer1_t = std::decay_t<std::invoke_result_t<Part1, const detail::parsed_t<Parse>&>>;
+    if constexpr (std::is_null_pointer_v<Part2>) {
+      return Answers<answer1_t>{.part1 = part1(parsed), .part2 = {}};
+    } else {
+      using answer2_t = std::decay_t<std::invoke_result_t<Part2, const detail::parsed_t<Parse>&>>;
+      return Answers<answer1_t, answer2_t>{.part1 = part1(parsed), .part2 = part2(parsed)};
+    }
+  }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "hash.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils {
+  // A day's parsed input written out as it sits in memory, so a later run can map the file
+  // and use it where it lies instead of parsing the text again.
+  //
+  // A snapshot is a header, a table of sections and then the sections themselves, each an
+  // array of some trivially copyable type starting on a 64-byte boundary. What the sections
+  // hold is up to the day, which gives its own layout number to bump whenever that changes.
+  // The header has a hash of everything after it, so a file that's been damaged or edited
+  // is turned away before anything in it is used.
+  // Snapshots are only read back on the machine that wrote them, so there's no attempt at
+  // endianness or padding portability.
+  namespace snapshot {
+    inline constexpr char Magic[8] = {'a', 'o', 'c', 's', 'n', 'a', 'p', '\0'};
+    inline constexpr uint32_t FormatVersion = 2;
+    inline constexpr size_t Alignment = 64;
+
+    struct header_t {
+      char magic[8];
+      uint32_t format;
+      uint32_t day;
+      uint32_t layout;
+      uint32_t sections;
+      hash128_t input; // of the text it was parsed from
+      hash128_t contents; // of the rest of the file
+    };
+
+    struct section_t {
+      uint64_t offset;
+      uint64_t count;
+      uint32_t element_size;
+      uint32_t padding;
+    };
+
+    inline size_t alignUp(size_t n) { return (n + Alignment - 1) & ~(Alignment - 1); }
+  }
+
+  // Whether some file contents are a snapshot rather than text
+  inline bool isSnapshot(std::string_view contents) {
+    return contents.size() >= sizeof(snapshot::header_t) && contents.starts_with({snapshot::Magic, sizeof(snapshot::Magic)});
+  }
+
+  class SnapshotWriter {
+    public:
+    template<typename T>
+    void add(std::span<const T> items) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      // padding would go into the file (and the hash) as whatever the stack had in it
+      static_assert(std::has_unique_object_representations_v<T>, "snapshot sections can't have padding");
+      sections_.push_back({.offset = data_.size(), .count = items.size(), .element_size = sizeof(T), .padding = 0});
+      const auto bytes = items.size_bytes();
+      data_.resize(snapshot::alignUp(data_.size() + bytes));
+      if (bytes) std::memcpy(data_.data() + sections_.back().offset, items.data(), bytes);
+    }
+    template<typename T>
+    void add(const std::vector<T>& items) { add(std::span<const T>{items}); }
+
+    void write(const std::string& path, int day, uint32_t layout, hash128_t input) const {
+      snapshot::header_t header{.magic = {}, .format = snapshot::FormatVersion, .day = static_cast<uint32_t>(day),
+        .layout = layout, .sections = static_cast<uint32_t>(sections_.size()), .input = input, .contents = {}};
+      std::memcpy(header.magic, snapshot::Magic, sizeof(header.magic));
+      const size_t data_start = snapshot::alignUp(sizeof(header) + sections_.size() * sizeof(snapshot::section_t));
+      auto sections = sections_;
+      for (auto& s : sections) s.offset += data_start;
+
+      // the table, padding up to the first section, then the sections
+      std::vector<char> rest(data_start - sizeof(header) + data_.size());
+      std::memcpy(rest.data(), sections.data(), sections.size() * sizeof(snapshot::section_t));
+      std::memcpy(rest.data() + data_start - sizeof(header), data_.data(), data_.size());
+      header.contents = hashBytes({rest.data(), rest.size()});
+
+      const auto out = fopen(path.c_str(), "wb");
+      if (!out) throw std::runtime_error(fmt::format("can't write the snapshot {}", path));
+      const bool ok = fwrite(&header, sizeof(header), 1, out) == 1 && fwrite(rest.data(), 1, rest.size(), out) == rest.size();
+      if (fclose(out) != 0 || !ok) throw std::runtime_error(fmt::format("can't write the snapshot {}", path));
+    }
+
+    private:
+    std::vector<snapshot::section_t> sections_;
+    std::vector<char> data_;
+  };
+
+  // A snapshot file mapped read-only. Sections come back as spans straight into the mapping,
+  // so whatever holds on to them holds on to the snapshot too. Opening one checks the
+  // sections are all inside the file, and it's up to the day to check what's in them.
+  class Snapshot {
+    public:
+    static std::shared_ptr<const Snapshot> open(const std::string& path) {
+      return std::shared_ptr<const Snapshot>(new Snapshot(path));
+    }
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot() {
+      if (map_ != MAP_FAILED) munmap(map_, size_);
+    }
+
+    int day() const { return header().day; }
+    uint32_t layout() const { return header().layout; }
+    hash128_t input() const { return header().input; }
+    size_t sections() const { return header().sections; }
+
+    template<typename T>
+    std::span<const T> section(size_t i) const {
+      static_assert(std::is_trivially_copyable_v<T>);
+      if (i >= sections()) throw std::runtime_error(fmt::format("snapshot has no section {}", i));
+      const auto& s = table()[i];
+      if (s.element_size != sizeof(T)) throw std::runtime_error(fmt::format("snapshot section {} isn't of this type", i));
+      return {reinterpret_cast<const T*>(static_cast<const char*>(map_) + s.offset), s.count};
+    }
+    // As section(i), for sections that always hold `count` items
+    template<typename T>
+    std::span<const T> section(size_t i, size_t count) const {
+      const auto result = section<T>(i);
+      check(result.size() == count, fmt::format("section {} has {} items rather than {}", i, result.size(), count));
+      return result;
+    }
+
+    // The header and table only say where the sections are, so each day's load() goes
+    // through what's in them with this before using any of it as an index
+    void check(bool ok, std::string_view what) const {
+      if (!ok) throw std::runtime_error(fmt::format("{} is corrupt: {}", path_, what));
+    }
+
+    private:
+    explicit Snapshot(const std::string& path) : path_(path) {
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd == -1) throw std::runtime_error(fmt::format("can't open the snapshot {}", path));
+      struct stat st;
+      if (fstat(fd, &st) == 0) size_ = st.st_size;
+      if (size_ >= sizeof(snapshot::header_t)) map_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (map_ == MAP_FAILED || !isSnapshot({static_cast<const char*>(map_), size_}))
+        throw std::runtime_error(fmt::format("{} isn't a snapshot", path));
+      if (header().format != snapshot::FormatVersion)
+        throw std::runtime_error(fmt::format("{} is snapshot format {}, not {}", path, header().format, snapshot::FormatVersion));
+
+      const auto* bytes = static_cast<const char*>(map_);
+      if (hashBytes({bytes + sizeof(snapshot::header_t), size_ - sizeof(snapshot::header_t)}) != header().contents)
+        throw std::runtime_error(fmt::format("{} is corrupt: its contents don't match their hash", path));
+
+      // every section has to be inside the file before anyone gets a span of it
+      const size_t table_end = sizeof(snapshot::header_t) + sections() * sizeof(snapshot::section_t);
+      if (table_end > size_) throw std::runtime_error(fmt::format("{} is cut short", path));
+      for (size_t i = 0; i < sections(); ++i) {
+        const auto& s = table()[i];
+        if (s.offset % snapshot::Alignment != 0 || s.offset > size_ || s.count > (size_ - s.offset) / std::max(s.element_size, 1u))
+          throw std::runtime_error(fmt::format("{} is cut short", path));
+      }
+    }
+
+    const snapshot::header_t& header() const { return *static_cast<const snapshot::header_t*>(map_); }
+    const snapshot::section_t* table() const {
+      return reinterpret_cast<const snapshot::section_t*>(static_cast<const char*>(map_) + sizeof(snapshot::header_t));
+    }
+
+    std::string path_;
+    void* map_ = MAP_FAILED;
+    size_t size_ = 0;
+  };
+}
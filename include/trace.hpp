@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#ifndef AOC_TRACE
+#define AOC_TRACE 0
+#endif
+
+namespace utils {
+  // Set with -DAOC_TRACE=1 to record the spans and counters below. Otherwise they're
+  // empty and their names are never even formatted.
+  inline constexpr bool Tracing = AOC_TRACE;
+
+  namespace trace {
+    using clock = std::chrono::steady_clock;
+
+    struct event_t {
+      std::string name;
+      char phase;      // 'X' for a span, 'C' for a counter
+      int64_t start;   // ns since the recorder started
+      int64_t value;   // duration for a span
+      int tid;
+    };
+
+    // Everything recorded so far, from every thread
+    class Recorder {
+      public:
+      static Recorder& get() {
+        static Recorder recorder;
+        return recorder;
+      }
+
+      int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count(); }
+
+      void add(event_t event) {
+        std::lock_guard lock{mutex_};
+        events_.push_back(std::move(event));
+      }
+
+      // Small ids in the order threads first record something, which read better in a
+      // trace viewer than the real ones
+      int threadId() {
+        thread_local const int id = next_tid_++;
+        return id;
+      }
+
+      // Writes everything out in Chrome's trace event format, for chrome://tracing or
+      // ui.perfetto.dev
+      void write(const std::string& filename) {
+        std::lock_guard lock{mutex_};
+        auto out = fopen(filename.c_str(), "w");
+        if (!out) throw std::runtime_error(fmt::format("couldn't open {} for the trace", filename));
+        fmt::print(out, "{{\"traceEvents\":[\n");
+        for (size_t i = 0; i < events_.size(); ++i) {
+          const auto& e = events_[i];
+          const auto name = escape(e.name);
+          fmt::print(out, "{{\"name\":\"{}\",\"ph\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}", name, e.phase, e.tid, e.start / 1e3);
+          if (e.phase == 'X') fmt::print(out, ",\"dur\":{:.3f}}}", e.value / 1e3);
+          else fmt::print(out, ",\"args\":{{\"{}\":{}}}}}", name, e.value);
+          fmt::print(out, "{}\n", i + 1 < events_.size() ? "," : "");
+        }
+        fmt::print(out, "]}}\n");
+        fclose(out);
+      }
+
+      private:
+      static std::string escape(std::string_view s) {
+        std::string result;
+        for (const char c : s) {
+          if (c == '"' || c == '\\') result.push_back('\\');
+          result.push_back(c);
+        }
+        return result;
+      }
+
+      const clock::time_point start_ = clock::now();
+      std::mutex mutex_;
+      std::vector<event_t> events_;
+      std::atomic<int> next_tid_ = 0;
+    };
+  }
+
+  // Records how long the scope it's in took, as a span named by formatting the arguments
+  template<bool Enabled>
+  class BasicTraceScope {
+    public:
+    template<typename... Args>
+    explicit BasicTraceScope(fmt::format_string<Args...> name, Args&&... args)
+      : name_(fmt::format(name, std::forward<Args>(args)...)), start_(trace::Recorder::get().now()) {}
+    BasicTraceScope(const BasicTraceScope&) = delete;
+    BasicTraceScope& operator=(const BasicTraceScope&) = delete;
+    ~BasicTraceScope() {
+      auto& recorder = trace::Recorder::get();
+      recorder.add({std::move(name_), 'X', start_, recorder.now() - start_, recorder.threadId()});
+    }
+
+    private:
+    std::string name_;
+    int64_t start_;
+  };
+
+  template<>
+  class BasicTraceScope<false> {
+    public:
+    template<typename... Args>
+    explicit BasicTraceScope(fmt::format_string<Args...>, Args&&...) {}
+  };
+
+  using TraceScope = BasicTraceScope<Tracing>;
+
+  // Records a value at this point in time, drawn as a graph under the spans
+  inline void traceCounter(std::string_view name, int64_t value) {
+    if constexpr (Tracing) {
+      auto& recorder = trace::Recorder::get();
+      recorder.add({std::string{name}, 'C', recorder.now(), value, recorder.threadId()});
+    }
+  }
+
+  inline void writeTrace(const std::string& filename) {
+    if constexpr (Tracing) trace::Recorder::get().write(filename);
+  }
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <filesystem>
 #include <optional>
 #include <string_view>
@@ -5,9 +7,25 @@
 #include <stdexcept>
 #include <fmt/core.h>
 #include <array>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <expected>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include <bit>
+#include <span>
+#include <vector>
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <immintrin.h>
 
 namespace utils {
   template<auto F>
@@ -38,24 +56,158 @@ namespace utils {
     while (!inp.empty() && inp.front() == ' ') inp.remove_prefix(1);
   }
 
-  inline int64_t parseInt(std::string_view& inp) {
-    int64_t result;
-    auto [ptr, ec] = std::from_chars(inp.data(), inp.data() + inp.size(), result);
-    if (ec != std::errc()) throw std::invalid_argument("integer could not be parsed from value");
-    inp.remove_prefix(ptr - inp.data());
+  // std::isdigit is undefined for negative chars, which any byte past ascii is
+  constexpr bool isDigit(char c) { return static_cast<unsigned>(static_cast<unsigned char>(c) - '0') < 10u; }
+
+  // Counts the leading ascii digits in 8 bytes of input (first char in the low byte)
+  inline int leadingDigitsSwar(uint64_t chunk) {
+    // A byte is a digit if its high nibble is 3 and adding 6 doesn't carry out of its low
+    // nibble. A carry out of a non-digit byte can upset the bytes above it, but we only
+    // count up to the first non-digit so that doesn't matter.
+    constexpr uint64_t high_nibbles = 0xF0F0F0F0F0F0F0F0;
+    constexpr uint64_t zeros = 0x3030303030303030;
+    const uint64_t non_digits = ((chunk & high_nibbles) ^ zeros)
+      | (((chunk + 0x0606060606060606) & high_nibbles) ^ zeros);
+    return std::countr_zero(non_digits) / 8;
+  }
+
+  // Turns `len` (1-8) leading ascii digits of chunk into their value
+  inline uint64_t parseDigitsSwar(uint64_t chunk, int len) {
+    constexpr uint64_t zeros = 0x3030303030303030;
+    // Drop everything after the digits and shift them to the top, which leaves leading zeros
+    chunk = (chunk - zeros) << (8 * (8 - len));
+    // Now combine neighbouring digits into 2, then 4, then all 8
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ull << 32)))
+        + (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32)))) >> 32;
+    return chunk;
+  }
+
+  // Loads the next 8 bytes of input, padding with zeros (which aren't digits) at the end
+  inline uint64_t loadChunk(std::string_view inp, size_t at) {
+    uint64_t chunk = 0;
+    if (inp.size() - at >= 8) [[likely]] memcpy(&chunk, inp.data() + at, 8);
+    else if (inp.size() > at) memcpy(&chunk, inp.data() + at, inp.size() - at);
+    return chunk;
+  }
+
+  // Carries on from a full chunk of 8 digits for numbers longer than that
+  [[gnu::noinline]] inline std::expected<uint64_t, std::errc> tryParseUIntTail(std::string_view& inp, uint64_t result) {
+    static constexpr uint64_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    size_t consumed = 8;
+    while (true) {
+      const uint64_t chunk = loadChunk(inp, consumed);
+      const int len = leadingDigitsSwar(chunk);
+      if (len == 0) break;
+      if (__builtin_mul_overflow(result, pow10[len], &result)
+          || __builtin_add_overflow(result, parseDigitsSwar(chunk, len), &result))
+        return std::unexpected(std::errc::result_out_of_range);
+      consumed += len;
+      if (len < 8) break;
+    }
+    inp.remove_prefix(consumed);
+    return result;
+  }
 
+  // Parses an unsigned decimal 8 digits at a time. Like std::from_chars this consumes
+  // nothing on failure. Numbers here are mostly short and this sits in every parser's
+  // inner loop, so the common case is forced inline.
+  [[gnu::always_inline]] inline std::expected<uint64_t, std::errc> tryParseUInt(std::string_view& inp) {
+    const uint64_t chunk = loadChunk(inp, 0);
+    const int len = leadingDigitsSwar(chunk);
+    if (len == 0) [[unlikely]] return std::unexpected(std::errc::invalid_argument);
+    const uint64_t result = parseDigitsSwar(chunk, len);
+    if (len == 8 && inp.size() > 8 && isDigit(inp[8])) [[unlikely]] return tryParseUIntTail(inp, result);
+    inp.remove_prefix(len);
     return result;
   }
 
-  inline int64_t parseHexInt(std::string_view& inp) {
+  [[gnu::always_inline]] inline std::expected<int64_t, std::errc> tryParseInt(std::string_view& inp) {
+    const uint64_t negative = !inp.empty() && inp.front() == '-';
+    std::string_view digits{inp.data() + negative, inp.size() - negative};
+    const auto magnitude = tryParseUInt(digits);
+    if (!magnitude) [[unlikely]] return std::unexpected(magnitude.error());
+
+    const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+    if (*magnitude > limit) [[unlikely]] return std::unexpected(std::errc::result_out_of_range);
+    inp = digits;
+    // conditionally negate without a branch
+    return static_cast<int64_t>((*magnitude ^ -negative) + negative);
+  }
+
+  inline std::expected<int64_t, std::errc> tryParseHexInt(std::string_view& inp) {
     int64_t result;
     auto [ptr, ec] = std::from_chars(inp.data(), inp.data() + inp.size(), result, 16);
-    if (ec != std::errc()) throw std::invalid_argument("integer could not be parsed from value");
+    if (ec != std::errc()) return std::unexpected(ec);
     inp.remove_prefix(ptr - inp.data());
 
     return result;
   }
 
+  inline int64_t parseInt(std::string_view& inp) {
+    auto result = tryParseInt(inp);
+    if (!result) throw std::invalid_argument("integer could not be parsed from value");
+    return *result;
+  }
+
+  inline int64_t parseHexInt(std::string_view& inp) {
+    auto result = tryParseHexInt(inp);
+    if (!result) throw std::invalid_argument("integer could not be parsed from value");
+    return *result;
+  }
+
+  // Bitmask of which of the 64 bytes at p are ascii digits
+  inline uint64_t digitMask64(const char* p) {
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    const auto mask32 = [&](const char* q) -> uint64_t {
+      // digits are the bytes that are still <= 9 (unsigned) after subtracting '0'
+      const auto c = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)), zero);
+      return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(c, nine), c)));
+    };
+    return mask32(p) | (mask32(p + 32) << 32);
+#else
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; ++i) mask |= static_cast<uint64_t>(isDigit(p[i])) << i;
+    return mask;
+#endif
+  }
+
+  // Parses every integer in inp (anything else is treated as a separator, and a '-' right
+  // before a number makes it negative) into out, returning how many were written. Digit
+  // runs are found 64 bytes at a time, so there's no per-character scanning between
+  // numbers. Throws if there are more than fit in out, so callers with a fixed size out
+  // never quietly lose numbers; size it from the input (inp.size() / 2 + 1) when unsure.
+  inline size_t parseInts(std::string_view inp, std::span<int64_t> out) {
+    size_t count = 0;
+    uint64_t carry = 0; // whether the block before ended on a digit
+    for (size_t block = 0; block < inp.size(); block += 64) {
+      uint64_t digits;
+      if (inp.size() - block >= 64) {
+        digits = digitMask64(inp.data() + block);
+      } else {
+        char tail[64] = {};
+        memcpy(tail, inp.data() + block, inp.size() - block);
+        digits = digitMask64(tail);
+      }
+      uint64_t starts = digits & ~((digits << 1) | carry);
+      carry = digits >> 63;
+
+      for (; starts; starts &= starts - 1) {
+        if (count == out.size()) [[unlikely]] throw std::out_of_range("more integers than fit");
+        const size_t pos = block + std::countr_zero(starts);
+        auto rest = inp.substr(pos);
+        const auto magnitude = tryParseUInt(rest);
+        const uint64_t negative = pos > 0 && inp[pos - 1] == '-';
+        const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+        if (!magnitude || *magnitude > limit) [[unlikely]] throw std::out_of_range("integer too large");
+        out[count++] = static_cast<int64_t>((*magnitude ^ -negative) + negative);
+      }
+    }
+    return count;
+  }
+
   inline std::string_view readToChar(char c, std::string_view& inp) {
     auto breakidx = inp.find(c);
     std::string_view result = inp.substr(0, breakidx);
@@ -68,46 +220,409 @@ namespace utils {
     return readToChar(' ', inp);
   }
 
+  // A string literal usable as a template argument
+  template<size_t N>
+  struct fixed_string {
+    char chars[N];
+    constexpr fixed_string(const char (&s)[N]) { std::copy_n(s, N, chars); }
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+  };
+
+  namespace detail {
+    // Where the literal text between the {} fields of a scan pattern lives. There's
+    // always one more literal than fields, though any of them can be empty.
+    template<fixed_string Pattern>
+    struct scan_pattern {
+      static constexpr std::string_view pattern = Pattern.view();
+      static constexpr size_t fields = [] {
+        size_t count = 0;
+        for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+          if (pattern[i] == '{' && pattern[i + 1] == '}') { ++count; ++i; }
+        }
+        return count;
+      }();
+      static constexpr auto literals = [] {
+        std::array<std::pair<size_t, size_t>, fields + 1> result;
+        size_t start = 0;
+        size_t lit = 0;
+        for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+          if (pattern[i] == '{' && pattern[i + 1] == '}') {
+            result[lit++] = {start, i - start};
+            start = i + 2;
+            ++i;
+          }
+        }
+        result[lit] = {start, pattern.size() - start};
+        return result;
+      }();
+      template<size_t I>
+      static constexpr std::string_view literal() {
+        return pattern.substr(literals[I].first, literals[I].second);
+      }
+    };
+
+    template<typename Pat, size_t I, bool Trusted>
+    void scanLiteral(std::string_view& inp) {
+      constexpr auto Lit = Pat::template literal<I>();
+      if constexpr (!Lit.empty()) {
+        if constexpr (!Trusted) {
+          if (inp.size() < Lit.size() || memcmp(inp.data(), Lit.data(), Lit.size()) != 0)
+            throw std::invalid_argument(fmt::format("scan expected '{}' at '{}'", Lit, inp));
+        }
+        inp.remove_prefix(Lit.size());
+      }
+    }
+
+    // A string_view field runs up to wherever the literal after it starts
+    template<typename T, typename Pat, size_t I, bool Trusted>
+    T scanField(std::string_view& inp) {
+      constexpr auto Next = Pat::template literal<I + 1>();
+      if constexpr (std::is_same_v<T, std::string_view>) {
+        if constexpr (Next.empty()) {
+          return std::exchange(inp, {});
+        } else {
+          return readToChar(Next.front(), inp);
+        }
+      } else if constexpr (std::is_same_v<T, char>) {
+        if constexpr (!Trusted) {
+          if (inp.empty()) throw std::invalid_argument("scan expected a char but no input remained");
+        }
+        const char result = inp.front();
+        inp.remove_prefix(1);
+        return result;
+      } else {
+        static_assert(std::is_integral_v<T>, "scan fields must be integers, chars or string_views");
+        // Even trusted input has to have a number here, or there'd be nothing to return
+        const auto result = tryParseInt(inp);
+        if (!result) [[unlikely]] throw std::invalid_argument(fmt::format("scan expected an integer at '{}'", inp));
+        if constexpr (!Trusted) {
+          if (!std::in_range<T>(*result))
+            throw std::out_of_range(fmt::format("scan got {}, which doesn't fit the field", *result));
+        }
+        return static_cast<T>(*result);
+      }
+    }
+
+    template<fixed_string Pattern, bool Trusted, typename... Fields, size_t... Is>
+    std::tuple<Fields...> scan(std::string_view inp, std::index_sequence<Is...>) {
+      using pat = scan_pattern<Pattern>;
+      static_assert(pat::fields == sizeof...(Fields), "scan pattern and field types don't match up");
+      static_assert(((!std::is_same_v<Fields, std::string_view> || !pat::template literal<Is + 1>().empty()
+              || Is + 1 == pat::fields) && ...),
+          "a string_view field needs a literal after it to know where it ends");
+
+      scanLiteral<pat, 0, Trusted>(inp);
+      // braced init so the fields are parsed in order
+      std::tuple<Fields...> result{[&] {
+        auto field = scanField<Fields, pat, Is, Trusted>(inp);
+        scanLiteral<pat, Is + 1, Trusted>(inp);
+        return field;
+      }()...};
+      if constexpr (!Trusted) {
+        if (!inp.empty()) throw std::invalid_argument(fmt::format("scan has input left over: '{}'", inp));
+      }
+      return result;
+    }
+  }
+
+  // Parses a whole line against a pattern fixed at compile time, where each {} is a field
+  // of the matching type, e.g. scan<"{x={},m={},a={},s={}}", int, int, int, int>(line).
+  // Literals are checked with fixed length compares, and anything that doesn't match, or
+  // an integer that doesn't fit its field, throws.
+  template<fixed_string Pattern, typename... Fields>
+  std::tuple<Fields...> scan(std::string_view inp) {
+    return detail::scan<Pattern, false, Fields...>(inp, std::index_sequence_for<Fields...>{});
+  }
+
+  // As scan, but for input we already know is well formed: literals are skipped over
+  // without being looked at and integers aren't range checked. A field that isn't an
+  // integer at all still throws.
+  template<fixed_string Pattern, typename... Fields>
+  std::tuple<Fields...> scanTrusted(std::string_view inp) {
+    return detail::scan<Pattern, true, Fields...>(inp, std::index_sequence_for<Fields...>{});
+  }
+
+  // Same as LineReader::getLine, but over a buffer we already have
+  inline std::optional<std::string_view> getLine(std::string_view& inp) {
+    if (inp.empty()) return std::nullopt;
+    auto idx = inp.find('\n');
+    auto ret = inp.substr(0, idx);
+    inp.remove_prefix(idx == inp.npos ? inp.size() : idx + 1); // also remove the newline itself
+    return ret;
+  }
+
+  // What Assert and AssertEq throw. Malformed input mostly ends up failing one of them, so
+  // whatever runs the day (batch, say) can put it down to that input and carry on.
+  struct assertion_error : std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
   template<typename T>
   void Assert(const T& x) {
-    if (!x) {
-      fmt::println("ASSERTION FAILED: {}", x);
-      std::terminate();
-    }
+    if (!x) throw assertion_error(fmt::format("ASSERTION FAILED: {}", x));
   }
   template<typename T>
   void AssertEq(const T& x, const T& y) {
-    if (x != y) {
-      fmt::println("ASSERTION FAILED: {} != {}", x, y);
-      std::terminate();
-    }
+    if (x != y) throw assertion_error(fmt::format("ASSERTION FAILED: {} != {}", x, y));
   }
 
+  // Reads a file line by line, handing out string_views straight into its contents.
+  //
+  // Regular files are mmapped. Anything else (pipes, stdin as "-", devices) can't be, so
+  // for those we fall back to large page-aligned read() buffers instead.
+  //
+  // By default the whole input is brought in at once and every view stays valid for the
+  // lifetime of the reader. Passing a `streaming` config instead only keeps a sliding
+  // window of the input around, so arbitrarily large inputs can be read with bounded RSS.
+  // For files the window is a mapping that we move along, dropping pages we've read past;
+  // for streams it's a buffer we refill. A line that crosses the end of the window is
+  // handled by moving the window to start at that line (growing it if the line is longer
+  // than the window). In streaming mode a view is only valid until the next getLine().
   class LineReader {
-    size_t bufidx_ = 0;
-    int fd_;
-    std::string_view view_;
-    void* map_data_;
-    size_t size_;
-
     public:
+    struct streaming {
+      size_t window = 64 << 20;
+      // How far we get past the already-dropped pages before we drop them again
+      size_t drop_chunk = 4 << 20;
+    };
+
     LineReader(const std::string& filename) {
-      auto full_filename = std::filesystem::current_path().string() + "/" + filename;
-      fd_ = open(full_filename.c_str(), O_RDONLY);
-      if (fd_ == -1) throw std::runtime_error("invalid filename!");
-      size_ = std::filesystem::file_size(filename);
-      map_data_ = mmap(0,  size_, PROT_READ, MAP_PRIVATE, fd_, 0);
-      if (map_data_ == nullptr) throw std::runtime_error("mmap failed!");
-      view_ = std::string_view(reinterpret_cast<char*>(map_data_), size_);
-    }
-    ~LineReader() { close(fd_); }
+      openFile(filename);
+      if (mapped_) {
+        window_ = size_;
+        if (size_ > 0) mapWindow(0);
+        else at_end_ = true;
+      } else {
+        readAll();
+      }
+    }
+    LineReader(const std::string& filename, streaming config) : streaming_(true), drop_chunk_(config.drop_chunk) {
+      openFile(filename);
+      // the window must cover at least a page, and mappings need to be page multiples
+      window_ = std::max(pageAlign(config.window + page_size_ - 1), page_size_);
+      if (mapped_) {
+        if (size_ > 0) mapWindow(0);
+        else at_end_ = true;
+      } else {
+        growBuffer(window_);
+        fillBuffer();
+      }
+    }
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+    ~LineReader() {
+      if (map_data_ != MAP_FAILED) munmap(map_data_, map_len_);
+      if (fd_ != STDIN_FILENO) close(fd_);
+    }
+
     std::optional<std::string_view> getLine() {
-      // find next \n
-      if (view_.empty()) return std::nullopt;
-      auto idx = view_.find('\n');
-      auto ret = view_.substr(0, idx);
-      view_.remove_prefix(idx + 1); // also remove the newline itself
-      return ret;
+      while (true) {
+        const char* begin = win_ + cur_;
+        const size_t avail = win_len_ - cur_;
+        // find next \n
+        const auto nl = avail ? static_cast<const char*>(memchr(begin, '\n', avail)) : nullptr;
+        if (nl) {
+          std::string_view ret{begin, static_cast<size_t>(nl - begin)};
+          advance(ret.size() + 1); // also remove the newline itself
+          return ret;
+        }
+        if (at_end_) {
+          if (avail == 0) return std::nullopt;
+          // last line has no trailing newline
+          advance(avail);
+          return std::string_view{begin, avail};
+        }
+        slideWindow();
+      }
+    }
+
+    // The whole input, only available when it isn't being streamed
+    std::string_view contents() const {
+      if (streaming_) throw std::logic_error("contents() is not available in streaming mode");
+      return {win_, win_len_};
+    }
+
+    private:
+    static size_t pageAlign(size_t n) { return n & ~(page_size_ - 1); }
+
+    void openFile(const std::string& filename) {
+      if (filename == "-") {
+        fd_ = STDIN_FILENO;
+      } else {
+        fd_ = open(filename.c_str(), O_RDONLY);
+        if (fd_ == -1) throw std::runtime_error("invalid filename!");
+      }
+      struct stat st;
+      if (fstat(fd_, &st) == -1) {
+        if (fd_ != STDIN_FILENO) close(fd_);
+        throw std::runtime_error("stat failed!");
+      }
+      mapped_ = S_ISREG(st.st_mode);
+      size_ = st.st_size;
+    }
+
+    void mapWindow(size_t offset) {
+      map_offset_ = offset;
+      map_len_ = std::min(window_, size_ - offset);
+      map_data_ = mmap(0, map_len_, PROT_READ, MAP_PRIVATE, fd_, offset);
+      if (map_data_ == MAP_FAILED) throw std::runtime_error("mmap failed!");
+      madvise(map_data_, map_len_, MADV_SEQUENTIAL);
+      dropped_ = offset;
+      win_ = static_cast<const char*>(map_data_);
+      win_len_ = map_len_;
+      cur_ = 0;
+      at_end_ = map_offset_ + map_len_ == size_;
+    }
+
+    // The current line runs past the end of the window, so move the window up to start at
+    // it. If that doesn't gain us any room the line is longer than the window and we have
+    // to grow it.
+    void slideWindow() {
+      if (mapped_) {
+        const auto pos = map_offset_ + cur_;
+        const auto offset = pageAlign(pos);
+        if (offset == map_offset_) window_ *= 2;
+        munmap(map_data_, map_len_);
+        map_data_ = MAP_FAILED;
+        mapWindow(offset);
+        cur_ = pos - offset;
+      } else {
+        const auto avail = win_len_ - cur_;
+        memmove(buffer_.get(), buffer_.get() + cur_, avail);
+        win_len_ = avail;
+        cur_ = 0;
+        if (win_len_ == capacity_) growBuffer(capacity_ * 2);
+        fillBuffer();
+      }
     }
+
+    void advance(size_t n) {
+      cur_ += n;
+      if (!streaming_ || !mapped_) return;
+      const auto pos = map_offset_ + cur_;
+      if (pos - dropped_ < drop_chunk_) return;
+      // Everything before the page we're on has been handed out already. The mapping is
+      // private and read-only, so if a caller does look at an old view again it just
+      // faults the page back in from the file.
+      const auto drop_to = pageAlign(pos);
+      madvise(static_cast<char*>(map_data_) + (dropped_ - map_offset_), drop_to - dropped_, MADV_DONTNEED);
+      dropped_ = drop_to;
+    }
+
+    void growBuffer(size_t capacity) {
+      buffer_t bigger{static_cast<char*>(std::aligned_alloc(page_size_, capacity))};
+      if (!bigger) throw std::bad_alloc();
+      if (win_len_ > 0) memcpy(bigger.get(), buffer_.get(), win_len_);
+      buffer_ = std::move(bigger);
+      capacity_ = capacity;
+      win_ = buffer_.get();
+    }
+
+    // Reads until the buffer is full or the input runs out
+    void fillBuffer() {
+      while (win_len_ < capacity_) {
+        const auto n = read(fd_, buffer_.get() + win_len_, capacity_ - win_len_);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error("read failed!");
+        if (n == 0) { at_end_ = true; return; }
+        win_len_ += n;
+      }
+    }
+
+    void readAll() {
+      growBuffer(read_chunk_);
+      while (!at_end_) {
+        if (win_len_ == capacity_) growBuffer(capacity_ * 2);
+        fillBuffer();
+      }
+    }
+
+    struct free_deleter { void operator()(char* p) const { std::free(p); } };
+    using buffer_t = std::unique_ptr<char[], free_deleter>;
+
+    static inline const size_t page_size_ = sysconf(_SC_PAGESIZE);
+    static constexpr size_t read_chunk_ = 1 << 20;
+
+    int fd_ = -1;
+    bool mapped_ = false;
+    bool streaming_ = false;
+    size_t drop_chunk_ = 0;
+    size_t size_ = 0;
+    size_t window_ = 0;
+
+    // The part of the input we can currently see, and how far into it we are
+    const char* win_ = nullptr;
+    size_t win_len_ = 0;
+    size_t cur_ = 0;
+    bool at_end_ = false;    // nothing comes after the window
+
+    // mmap state for regular files
+    size_t dropped_ = 0;    // pages before this file offset have been released
+    size_t map_offset_ = 0; // file offset the current mapping starts at
+    size_t map_len_ = 0;
+    void* map_data_ = MAP_FAILED;
+
+    // read() state for everything else
+    buffer_t buffer_;
+    size_t capacity_ = 0;
+  };
+
+  // Random access to every line of a buffer. The newlines are all found up front in one
+  // vectorised pass, and since grids tend to have a fixed width we also note that so
+  // callers can size things once.
+  class LineIndex {
+    public:
+    explicit LineIndex(std::string_view buf) {
+      // Guess the line count from the first line, which is exact for grids
+      const auto first = buf.find('\n');
+      if (first != buf.npos) lines_.reserve(buf.size() / (first + 1) + 1);
+
+      const char* base = buf.data();
+      const size_t n = buf.size();
+      size_t start = 0;
+      const auto newline = [&](size_t idx) {
+        lines_.emplace_back(base + start, idx - start);
+        start = idx + 1;
+      };
+
+      size_t i = 0;
+#if defined(__AVX2__)
+      const __m256i nl = _mm256_set1_epi8('\n');
+      for (; i + 32 <= n; i += 32) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, nl));
+        for (; mask; mask &= mask - 1) newline(i + std::countr_zero(mask));
+      }
+#elif defined(__SSE2__)
+      const __m128i nl = _mm_set1_epi8('\n');
+      for (; i + 16 <= n; i += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        for (; mask; mask &= mask - 1) newline(i + std::countr_zero(mask));
+      }
+#endif
+      for (; i < n; ++i) {
+        if (base[i] == '\n') newline(i);
+      }
+      // last line has no trailing newline
+      if (start < n) lines_.emplace_back(base + start, n - start);
+
+      if (!lines_.empty() && std::all_of(lines_.begin(), lines_.end(),
+            [w = lines_.front().size()](const auto l) { return l.size() == w; }))
+        width_ = lines_.front().size();
+    }
+
+    std::string_view line(size_t i) const { return lines_[i]; }
+    std::string_view operator[](size_t i) const { return lines_[i]; }
+    size_t size() const { return lines_.size(); }
+    // Set if every line is the same length
+    std::optional<size_t> width() const { return width_; }
+    std::span<const std::string_view> lines() const { return lines_; }
+    auto begin() const { return lines_.begin(); }
+    auto end() const { return lines_.end(); }
+
+    private:
+    std::vector<std::string_view> lines_;
+    std::optional<size_t> width_;
   };
 }
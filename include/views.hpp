@@ -0,0 +1,143 @@
+#pragma once
+
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string_view>
+
+namespace utils {
+  namespace detail {
+    // The pieces of a buffer, cut off the front one at a time as the view is walked. Take
+    // has the shape of getLine: it removes the next piece from the string_view it's given
+    // and returns it, or nullopt once there are none left. Pieces are views into the
+    // buffer, so walking one allocates and copies nothing, and they stay valid for as long
+    // as the buffer does rather than the view.
+    template<typename Take>
+    class PiecesView : public std::ranges::view_interface<PiecesView<Take>> {
+      public:
+      class iterator {
+        public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(std::string_view rest, Take take) : rest_(rest), take_(take) { ++*this; }
+
+        std::string_view operator*() const { return piece_; }
+        iterator& operator++() {
+          if (auto piece = take_(rest_)) piece_ = *piece;
+          else { piece_ = {}; done_ = true; }
+          return *this;
+        }
+        iterator operator++(int) {
+          auto old = *this;
+          ++*this;
+          return old;
+        }
+
+        // pieces only ever move forward through the buffer, so where one starts says which it is
+        bool operator==(const iterator& other) const {
+          return done_ == other.done_ && (done_ || piece_.data() == other.piece_.data());
+        }
+        bool operator==(std::default_sentinel_t) const { return done_; }
+
+        private:
+        std::string_view rest_;
+        std::string_view piece_;
+        Take take_{};
+        bool done_ = false;
+      };
+
+      PiecesView() = default;
+      PiecesView(std::string_view buffer, Take take) : buffer_(buffer), take_(take) {}
+
+      iterator begin() const { return {buffer_, take_}; }
+      std::default_sentinel_t end() const { return {}; }
+
+      private:
+      std::string_view buffer_;
+      Take take_{};
+    };
+
+    struct take_line_t {
+      std::optional<std::string_view> operator()(std::string_view& rest) const { return getLine(rest); }
+    };
+
+    struct take_field_t {
+      char delim = ',';
+      std::optional<std::string_view> operator()(std::string_view& rest) const {
+        if (rest.empty()) return std::nullopt;
+        const auto idx = rest.find(delim);
+        const auto result = rest.substr(0, idx);
+        rest.remove_prefix(idx == rest.npos ? rest.size() : idx + 1);
+        return result;
+      }
+    };
+
+    // A block runs up to a blank line, and doesn't keep the newline ending its last line.
+    // Any more blank lines before the next block are skipped, so none are ever empty.
+    struct take_block_t {
+      std::optional<std::string_view> operator()(std::string_view& rest) const {
+        rest.remove_prefix(std::min(rest.find_first_not_of('\n'), rest.size()));
+        if (rest.empty()) return std::nullopt;
+        const auto idx = rest.find("\n\n");
+        auto result = rest.substr(0, idx);
+        rest.remove_prefix(idx == rest.npos ? rest.size() : idx + 2);
+        if (result.ends_with('\n')) result.remove_suffix(1);
+        return result;
+      }
+    };
+
+    struct take_token_t {
+      std::string_view separators = " \n";
+      std::optional<std::string_view> operator()(std::string_view& rest) const {
+        const auto start = rest.find_first_not_of(separators);
+        if (start == rest.npos) {
+          rest = {};
+          return std::nullopt;
+        }
+        rest.remove_prefix(start);
+        const auto result = rest.substr(0, rest.find_first_of(separators));
+        rest.remove_prefix(result.size());
+        return result;
+      }
+    };
+  }
+
+  // Lazy views over a buffer, for parsers that want to walk it in one pass without
+  // collecting lines into a vector first. They're forward ranges of string_views, so they
+  // compose with std::views and each other, e.g. lines(block) for each of blocks(input).
+
+  // Every line, without its newline (as getLine)
+  inline auto lines(std::string_view buffer) {
+    return detail::PiecesView<detail::take_line_t>{buffer, {}};
+  }
+
+  // Every field between delimiters. Empty fields between two delimiters are kept, but a
+  // delimiter at the very end doesn't make one.
+  inline auto split(std::string_view buffer, char delim) {
+    return detail::PiecesView<detail::take_field_t>{buffer, {.delim = delim}};
+  }
+
+  // Every run of lines up to a blank line (or several), as patterns and sections of input
+  // tend to be
+  inline auto blocks(std::string_view buffer) {
+    return detail::PiecesView<detail::take_block_t>{buffer, {}};
+  }
+
+  // Every run of characters that aren't separators, skipping any empty ones
+  inline auto tokens(std::string_view buffer, std::string_view separators = " \n") {
+    return detail::PiecesView<detail::take_token_t>{buffer, {.separators = separators}};
+  }
+}
+
+template<typename Take>
+inline constexpr bool std::ranges::enable_borrowed_range<utils::detail::PiecesView<Take>> = true;
+
+static_assert(std::ranges::forward_range<decltype(utils::lines({}))>);
+static_assert(std::ranges::view<decltype(utils::lines({}))>);
+static_assert(std::ranges::borrowed_range<decltype(utils::lines({}))>);
@@ -0,0 +1,39 @@
+#include "alloc_stats.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete with ones that count into
+// utils::alloc::counts (and the process-wide counts, while a scope is watching them) on
+// the way through to malloc. Only linked in with AOC_ALLOC_STATS, and never alongside
+// mimalloc-static, which brings its own.
+//
+// The array and nothrow forms all come back through these.
+
+namespace {
+  void* counted(size_t size, size_t alignment) {
+    auto& counts = utils::alloc::counts;
+    ++counts.allocations;
+    counts.bytes += size;
+    if (utils::alloc::watching.load(std::memory_order_relaxed)) {
+      utils::alloc::allocations.fetch_add(1, std::memory_order_relaxed);
+      utils::alloc::bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    size = std::max<size_t>(size, 1);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    auto p = alignment <= alignof(std::max_align_t)
+      ? std::malloc(size)
+      : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (!p) throw std::bad_alloc{};
+    return p;
+  }
+}
+
+void* operator new(size_t size) { return counted(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return counted(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,327 @@
+#include "alloc_stats.hpp"
+#include "answer_cache.hpp"
+#include "parallel.hpp"
+#include "perf.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <fmt/format.h>
+#include <future>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Runs any of the days linked in, each on its own input, and times the phases.
+//
+//   aoc                  every day on inp/dayN.txt
+//   aoc 5 9=big.txt      day 5 on its default input, day 9 on big.txt ('-' is stdin)
+//   aoc -j               every day at once, one thread per core (-j4 for four threads)
+//   aoc -p               hardware counters for each phase as well, if perf lets us
+//   aoc -t0              each day's own parallel work on its own thread (-t4 for a pool of four)
+//   aoc -c               answers for inputs seen before from aoc_cache.bin (-cother.bin for another)
+//   aoc -w 5             also writes what day 5 parsed to inp/day5.txt.snap, for any day that can
+//   aoc 5=day5.txt.snap  a snapshot in place of the text is loaded rather than parsed
+//   day5 big.txt         a binary with a single day in it takes just the path as well
+//
+// Built with AOC_ALLOC_STATS it also says how much each phase allocated.
+
+struct job_t {
+  const utils::Day* day;
+  std::string input;
+};
+
+struct options_t {
+  std::vector<job_t> jobs;
+  size_t threads = 0; // 0 runs the days one after another on the main thread
+  std::optional<size_t> day_threads; // for the global pool, the days' own parallel work
+  bool perf = false;
+  std::optional<std::string> cache;
+  bool write_snapshots = false;
+};
+
+struct timings_t {
+  using ms = std::chrono::duration<double, std::milli>;
+  ms hash{};
+  ms parse{};
+  ms part1{};
+  ms part2{};
+};
+
+struct counts_t {
+  utils::perf_sample_t parse;
+  utils::perf_sample_t part1;
+  utils::perf_sample_t part2;
+};
+
+struct allocs_t {
+  utils::alloc_stats_t parse;
+  utils::alloc_stats_t part1;
+  utils::alloc_stats_t part2;
+};
+
+struct result_t {
+  std::string part1;
+  std::optional<std::string> part2;
+  timings_t timings;
+  counts_t counts;
+  allocs_t allocs;
+};
+
+options_t parseArgs(int argc, char **argv) {
+  const auto& days = utils::days();
+  options_t result;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (utils::eatLiteral("-j", arg)) {
+      int64_t threads = std::max(1u, std::thread::hardware_concurrency());
+      if (!arg.empty()) threads = utils::tryParseInt(arg).value_or(0);
+      if (threads <= 0 || !arg.empty())
+        throw std::invalid_argument(fmt::format("expected a thread count after -j, got '{}'", argv[i]));
+      result.threads = threads;
+      continue;
+    }
+    if (utils::eatLiteral("-t", arg)) {
+      const auto threads = utils::tryParseInt(arg);
+      if (!threads || *threads < 0 || !arg.empty())
+        throw std::invalid_argument(fmt::format("expected a thread count after -t, got '{}'", argv[i]));
+      result.day_threads = *threads;
+      continue;
+    }
+    if (utils::eatLiteral("-c", arg)) {
+      result.cache = arg.empty() ? "aoc_cache.bin" : std::string{arg};
+      continue;
+    }
+    if (arg == "-w") {
+      result.write_snapshots = true;
+      continue;
+    }
+    if (arg == "-p") {
+      result.perf = true;
+      continue;
+    }
+
+    int number = 0;
+    auto [rest, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), number);
+    std::string_view input{rest, arg.data() + arg.size()};
+    if (ec != std::errc{} || !(input.empty() || input.starts_with('='))) {
+      if (days.size() != 1)
+        throw std::invalid_argument(fmt::format("expected a day, or day=input, got '{}'", arg));
+      result.jobs.push_back({&days.begin()->second, std::string{arg}});
+      continue;
+    }
+
+    auto it = days.find(number);
+    if (it == days.end()) throw std::invalid_argument(fmt::format("day {} isn't in this binary", number));
+    result.jobs.push_back({&it->second, input.empty() ? it->second.defaultInput() : std::string{input.substr(1)}});
+  }
+
+  if (result.jobs.empty()) {
+    for (const auto& [_n, day] : days) result.jobs.push_back({&day, day.defaultInput()});
+  }
+  return result;
+}
+
+result_t run(const job_t& job, const options_t& options, utils::AnswerCache* cache) {
+  using clock = std::chrono::steady_clock;
+  const auto& day = *job.day;
+
+  result_t result;
+  std::optional<utils::PerfCounters> counters;
+  if (options.perf) counters.emplace();
+  // with -j the phases of other days run at the same time, and would count each other's
+  // allocations and reset each other's peaks
+  const auto counted = [&counters, &options](utils::perf_sample_t& sample, utils::alloc_stats_t& allocs, auto phase) {
+    utils::AllocScope alloc_scope{allocs, options.threads == 0};
+    if (!counters) return phase();
+    utils::PerfScope scope{*counters, sample};
+    return phase();
+  };
+
+  utils::TraceScope trace{"day{}", day.number};
+  utils::LineReader lr{job.input};
+  std::optional<utils::hash128_t> hash;
+  if (cache) {
+    utils::TraceScope trace{"day{} hash", day.number};
+    const auto hash_start = clock::now();
+    hash = utils::hashBytes(lr.contents());
+    result.timings.hash = clock::now() - hash_start;
+    if (auto answers = cache->find(day.number, *hash)) {
+      result.part1 = std::move(answers->part1);
+      result.part2 = std::move(answers->part2);
+      return result;
+    }
+  }
+
+  auto start = clock::now();
+  const bool snapshot = utils::isSnapshot(lr.contents());
+  auto parsed = counted(result.counts.parse, result.allocs.parse, [&] {
+    utils::TraceScope trace{"day{} parse", day.number};
+    if (snapshot) return utils::loadSnapshot(day, job.input);
+    return day.parse(lr.contents());
+  });
+  result.timings.parse = clock::now() - start;
+  // not part of any phase's time
+  if (options.write_snapshots && !snapshot && day.save) {
+    utils::saveSnapshot(day, parsed, hash ? *hash : utils::hashBytes(lr.contents()), job.input + ".snap");
+  }
+
+  const auto p1_start = clock::now();
+  result.part1 = counted(result.counts.part1, result.allocs.part1, [&] {
+    utils::TraceScope trace{"day{} part 1", day.number};
+    return day.part1(parsed);
+  });
+  auto p1_at = clock::now();
+  result.timings.part1 = p1_at - p1_start;
+
+  if (day.part2) {
+    result.part2 = counted(result.counts.part2, result.allocs.part2, [&] {
+      utils::TraceScope trace{"day{} part 2", day.number};
+      return day.part2(parsed);
+    });
+    result.timings.part2 = clock::now() - p1_at;
+  }
+  if (cache) cache->store(day.number, *hash, {.part1 = result.part1, .part2 = result.part2});
+  return result;
+}
+
+void printAnswers(const job_t& job, const result_t& result) {
+  fmt::println("Day{}: Part 1: {}", job.day->number, result.part1);
+  if (result.part2) fmt::println("Day{}: Part 2: {}", job.day->number, *result.part2);
+}
+
+// Days are independent, so they can all go on a pool at once. The most expensive start
+// first so the run isn't left waiting on one that was picked up last. The days' own
+// parallel bits use the global pool, which these threads are kept apart from; they help
+// out with its tasks while they wait on it.
+std::vector<result_t> runConcurrently(const options_t& options, utils::AnswerCache* cache) {
+  const auto& jobs = options.jobs;
+  std::vector<size_t> order(jobs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+      [&jobs](size_t l, size_t r) { return jobs[l].day->cost > jobs[r].day->cost; });
+
+  utils::ThreadPool pool{options.threads};
+  std::vector<std::future<result_t>> futures(jobs.size());
+  for (auto i : order) futures[i] = pool.submit([&job = jobs[i], &options, cache] { return run(job, options, cache); });
+
+  // Answers still come out in day order, each as soon as everything before it is done
+  std::vector<result_t> results;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    results.push_back(futures[i].get());
+    printAnswers(jobs[i], results.back());
+  }
+  return results;
+}
+
+int main(int argc, char **argv) {
+  options_t options;
+  try {
+    options = parseArgs(argc, argv);
+  } catch (const std::invalid_argument& e) {
+    fmt::println(stderr, "{}", e.what());
+    fmt::println(stderr, "usage: {} [-j[threads]] [-t<threads>] [-c[cache]] [-w] [-p] [day[=input]]...", argv[0]);
+    return 1;
+  }
+  const auto& jobs = options.jobs;
+  if (options.day_threads) utils::ThreadPool::globalThreads() = *options.day_threads;
+  std::optional<utils::AnswerCache> cache;
+  try {
+    if (options.cache) cache.emplace(*options.cache);
+  } catch (const std::runtime_error& e) {
+    fmt::println(stderr, "{}", e.what());
+    return 1;
+  }
+  auto* cache_ptr = cache ? &*cache : nullptr;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<result_t> results;
+  // A malformed input, or a day failing its own test, stops the run with whatever it threw
+  try {
+    // Each day's test once, however many inputs it's been given, before any of them run
+    std::set<int> tested;
+    for (const auto& job : jobs) {
+      if (job.day->test && tested.insert(job.day->number).second) job.day->test();
+    }
+    if (options.threads) {
+      results = runConcurrently(options, cache_ptr);
+    } else {
+      for (const auto& job : jobs) {
+        results.push_back(run(job, options, cache_ptr));
+        printAnswers(job, results.back());
+      }
+    }
+  } catch (const std::exception& e) {
+    fmt::println(stderr, "{}", e.what());
+    return 1;
+  }
+  const timings_t::ms wall = std::chrono::steady_clock::now() - start;
+
+  // Answers go to stdout as they always have, the times to stderr
+  timings_t total;
+  fmt::println(stderr, "{:>5} {:>12} {:>12} {:>12}", "day", "parse (ms)", "part 1 (ms)", "part 2 (ms)");
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    const auto& t = results[i].timings;
+    fmt::println(stderr, "{:>5} {:>12.3f} {:>12.3f} {:>12.3f}", jobs[i].day->number, t.parse.count(), t.part1.count(), t.part2.count());
+    total.hash += t.hash;
+    total.parse += t.parse;
+    total.part1 += t.part1;
+    total.part2 += t.part2;
+  }
+  fmt::println(stderr, "{:>5} {:>12.3f} {:>12.3f} {:>12.3f}", "total", total.parse.count(), total.part1.count(), total.part2.count());
+  fmt::println(stderr, "wall time {:.3f} ms{}", wall.count(),
+      options.threads ? fmt::format(" on {} threads", options.threads) : "");
+  if (cache) {
+    const auto stats = cache->stats();
+    fmt::println(stderr, "answer cache: {} hits, {} misses, {} stored, hashing took {:.3f} ms",
+        stats.hits, stats.misses, stats.stores, total.hash.count());
+  }
+
+  // Counters only cover the thread running the phase, not work it hands to the pool
+  if (options.perf) {
+    if (!utils::PerfCounters{}.available()) {
+      fmt::println(stderr, "hardware counters aren't available here, try lowering kernel.perf_event_paranoid");
+    }
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      const auto& c = results[i].counts;
+      fmt::println(stderr, "{:>5} parse  {}", jobs[i].day->number, c.parse.summary());
+      fmt::println(stderr, "{:>5} part 1 {}", jobs[i].day->number, c.part1.summary());
+      if (results[i].part2) fmt::println(stderr, "{:>5} part 2 {}", jobs[i].day->number, c.part2.summary());
+    }
+  }
+
+  // Allocations include the ones made by the day's work on the pool, but with -j there's
+  // no telling whose those are, so they're only the ones made on the day's own thread and
+  // the peak, which is the whole process's, isn't measured
+  if constexpr (utils::AllocStats) {
+    const auto show = [](const utils::alloc_stats_t& a) {
+      return fmt::format("{:>10} {:>10.2f} {:>10}", a.allocations, a.bytes / double(1 << 20),
+          a.peak_rss ? fmt::format("{:.2f}", *a.peak_rss / 1024.0) : "n/a");
+    };
+    fmt::println(stderr, "{:>5} {:>6} {:>10} {:>10} {:>10}", "day", "phase", "allocs", "MiB", "peak MiB");
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      const auto& a = results[i].allocs;
+      utils::alloc_stats_t day = a.parse;
+      fmt::println(stderr, "{:>5} {:>6} {}", jobs[i].day->number, "parse", show(a.parse));
+      fmt::println(stderr, "{:>5} {:>6} {}", "", "part 1", show(a.part1));
+      day += a.part1;
+      if (results[i].part2) {
+        fmt::println(stderr, "{:>5} {:>6} {}", "", "part 2", show(a.part2));
+        day += a.part2;
+      }
+      fmt::println(stderr, "{:>5} {:>6} {}", "", "all", show(day));
+    }
+  }
+
+  if constexpr (utils::Tracing) {
+    utils::writeTrace("trace.json");
+    fmt::println(stderr, "trace written to trace.json");
+  }
+}
@@ -0,0 +1,304 @@
+#include "answer_cache.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <filesystem>
+#include <fmt/format.h>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Solves one day on lots of inputs in one process, and writes every input's answers out.
+//
+//   batch 5 inputs/              every file in inputs/
+//   batch 5 @list.txt            every path listed in list.txt, one per line
+//   batch 5 a.txt b.txt          just these
+//   batch -j4 5 inputs/          on four threads rather than one per core
+//   batch -o out.json 5 inputs/  JSON to out.json rather than CSV to stdout (out.csv for CSV)
+//   batch -c 5 inputs/           answers for inputs seen before from aoc_cache.bin, as aoc -c
+//
+// The inputs are spread across the pool, so each day's own parallel work is sequential
+// unless -t asks for a pool of its own (as for aoc). Rows come out in the order the inputs
+// finish rather than the order they were given. Throughput goes to stderr.
+
+struct options_t {
+  const utils::Day* day = nullptr;
+  std::vector<std::string> inputs;
+  size_t threads = utils::ThreadPool::defaultThreads();
+  size_t day_threads = 0;
+  std::optional<std::string> output;
+  std::optional<std::string> cache;
+};
+
+struct result_t {
+  std::string part1;
+  std::optional<std::string> part2;
+  std::optional<std::string> error;
+  bool cached = false;
+  double ms = 0;
+};
+
+// Every path in a list file, skipping blank lines
+void addListed(const std::string& list, std::vector<std::string>& inputs) {
+  utils::LineReader lr{list};
+  while (auto line = lr.getLine()) {
+    if (!line->empty()) inputs.emplace_back(*line);
+  }
+}
+
+// Every regular file in a directory, by name
+void addDirectory(const std::filesystem::path& dir, std::vector<std::string>& inputs) {
+  std::vector<std::string> found;
+  for (const auto& entry : std::filesystem::directory_iterator{dir}) {
+    if (entry.is_regular_file()) found.push_back(entry.path().string());
+  }
+  std::sort(found.begin(), found.end());
+  inputs.insert(inputs.end(), found.begin(), found.end());
+}
+
+options_t parseArgs(int argc, char **argv) {
+  const auto& days = utils::days();
+  options_t result;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (utils::eatLiteral("-j", arg)) {
+      const auto threads = utils::tryParseInt(arg);
+      if (!threads || *threads <= 0 || !arg.empty())
+        throw std::invalid_argument(fmt::format("expected a thread count after -j, got '{}'", argv[i]));
+      result.threads = *threads;
+      continue;
+    }
+    if (utils::eatLiteral("-t", arg)) {
+      const auto threads = utils::tryParseInt(arg);
+      if (!threads || *threads < 0 || !arg.empty())
+        throw std::invalid_argument(fmt::format("expected a thread count after -t, got '{}'", argv[i]));
+      result.day_threads = *threads;
+      continue;
+    }
+    if (utils::eatLiteral("-c", arg)) {
+      result.cache = arg.empty() ? "aoc_cache.bin" : std::string{arg};
+      continue;
+    }
+    if (arg == "-o") {
+      if (++i == argc) throw std::invalid_argument("expected a file after -o");
+      result.output = argv[i];
+      continue;
+    }
+
+    if (!result.day) {
+      const auto number = utils::tryParseInt(arg);
+      const auto it = number && arg.empty() ? days.find(*number) : days.end();
+      if (it == days.end()) throw std::invalid_argument(fmt::format("expected a day in this binary, got '{}'", argv[i]));
+      result.day = &it->second;
+    } else if (utils::eatLiteral("@", arg)) {
+      addListed(std::string{arg}, result.inputs);
+    } else if (std::filesystem::is_directory(arg)) {
+      addDirectory(arg, result.inputs);
+    } else {
+      result.inputs.emplace_back(arg);
+    }
+  }
+  if (!result.day) throw std::invalid_argument("expected a day");
+  if (result.inputs.empty()) throw std::invalid_argument("expected some inputs");
+  return result;
+}
+
+// Reads a whole file into `buffer`, which each worker keeps between inputs so it only
+// grows to the biggest input it's seen rather than being allocated (or mapped) afresh
+// every time
+std::string_view readInto(const std::string& path, std::string& buffer) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) throw std::runtime_error(fmt::format("can't open {}", path));
+  size_t size = 0;
+  while (true) {
+    if (buffer.size() - size < 64 << 10) {
+      buffer.resize_and_overwrite(std::max<size_t>(buffer.size() * 2, 256 << 10), [](char*, size_t n) { return n; });
+    }
+    const auto got = read(fd, buffer.data() + size, buffer.size() - size);
+    if (got < 0) {
+      close(fd);
+      throw std::runtime_error(fmt::format("can't read {}", path));
+    }
+    if (got == 0) break;
+    size += got;
+  }
+  close(fd);
+  return {buffer.data(), size};
+}
+
+// Days that can reparse get what they parsed for the worker's last input back, so their
+// structures also only grow to the biggest input the worker has seen
+result_t solve(const utils::Day& day, const std::string& path, size_t& bytes, utils::AnswerCache* cache) {
+  thread_local std::string buffer;
+  thread_local std::any scratch;
+  utils::TraceScope trace{"day{} {}", day.number, path};
+  result_t result;
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    const auto input = readInto(path, buffer);
+    bytes = input.size();
+    const auto hash = cache ? utils::hashBytes(input) : utils::hash128_t{};
+    if (auto answers = cache ? cache->find(day.number, hash) : std::nullopt) {
+      result.part1 = std::move(answers->part1);
+      result.part2 = std::move(answers->part2);
+      result.cached = true;
+    } else {
+      const auto parsed = day.reparse ? day.reparse(input, scratch) : day.parse(input);
+      result.part1 = day.part1(parsed);
+      if (day.part2) result.part2 = day.part2(parsed);
+      if (cache) cache->store(day.number, hash, {.part1 = result.part1, .part2 = result.part2});
+    }
+  } catch (const std::exception& e) {
+    result.error = e.what();
+  }
+  result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+// Quoted when it has to be, doubling any quotes inside
+std::string csvField(std::string_view s) {
+  if (s.find_first_of(",\"\n") == s.npos) return std::string{s};
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"') result += '"';
+    result += c;
+  }
+  return result + '"';
+}
+
+std::string jsonString(std::string_view s) {
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') result += '\\';
+    if (static_cast<unsigned char>(c) < 0x20) result += fmt::format("\\u{:04x}", int(c));
+    else result += c;
+  }
+  return result + '"';
+}
+
+// Rows go out as each input finishes, in whatever order that is, and are flushed straight
+// away so whatever was answered survives the batch dying part way through
+class ResultWriter {
+  public:
+  ResultWriter(FILE* out, const options_t& options)
+      : out_(out), options_(options), json_(options.output && options.output->ends_with(".json")) {
+    fmt::println(out_, "{}", json_ ? "[" : "day,input,part1,part2,cached,ms,error");
+    fflush(out_);
+  }
+  ResultWriter(const ResultWriter&) = delete;
+  ResultWriter& operator=(const ResultWriter&) = delete;
+  ~ResultWriter() {
+    if (json_) fmt::println(out_, "{}]", rows_ ? "\n" : "");
+    fflush(out_);
+  }
+
+  void write(size_t i, const result_t& r) {
+    std::lock_guard lock{mutex_};
+    if (json_) {
+      const auto optional = [](const std::optional<std::string>& s) { return s ? jsonString(*s) : "null"; };
+      fmt::print(out_, R"({}  {{"day": {}, "input": {}, "part1": {}, "part2": {}, "cached": {}, "ms": {:.3f}, "error": {}}})",
+          rows_ ? ",\n" : "", options_.day->number, jsonString(options_.inputs[i]), r.error ? "null" : jsonString(r.part1),
+          optional(r.part2), r.cached, r.ms, optional(r.error));
+    } else {
+      fmt::println(out_, "{},{},{},{},{},{:.3f},{}", options_.day->number, csvField(options_.inputs[i]), csvField(r.part1),
+          csvField(r.part2.value_or("")), r.cached, r.ms, csvField(r.error.value_or("")));
+    }
+    fflush(out_);
+    ++rows_;
+  }
+
+  private:
+  FILE* out_;
+  const options_t& options_;
+  bool json_;
+  size_t rows_ = 0;
+  std::mutex mutex_;
+};
+
+int main(int argc, char **argv) {
+  options_t options;
+  try {
+    options = parseArgs(argc, argv);
+  } catch (const std::exception& e) {
+    fmt::println(stderr, "{}", e.what());
+    fmt::println(stderr, "usage: {} [-j<threads>] [-t<threads>] [-c[cache]] [-o out.csv|out.json] day (dir|@list|input)...", argv[0]);
+    return 1;
+  }
+  utils::ThreadPool::globalThreads() = options.day_threads;
+  const auto& day = *options.day;
+  if (day.test) day.test();
+  std::optional<utils::AnswerCache> cache;
+  try {
+    if (options.cache) cache.emplace(*options.cache);
+  } catch (const std::runtime_error& e) {
+    fmt::println(stderr, "{}", e.what());
+    return 1;
+  }
+  auto* cache_ptr = cache ? &*cache : nullptr;
+
+  // Biggest first, so the run isn't left waiting on a big one that was picked up last
+  const auto& inputs = options.inputs;
+  std::vector<size_t> order(inputs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<uintmax_t> sizes(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::error_code ec;
+    sizes[i] = std::filesystem::file_size(inputs[i], ec);
+  }
+  std::stable_sort(order.begin(), order.end(), [&sizes](size_t l, size_t r) { return sizes[l] > sizes[r]; });
+
+  FILE* out = stdout;
+  if (options.output) {
+    out = fopen(options.output->c_str(), "w");
+    if (!out) {
+      fmt::println(stderr, "can't write {}", *options.output);
+      return 1;
+    }
+  }
+
+  std::vector<result_t> results(inputs.size());
+  std::vector<size_t> bytes(inputs.size());
+  const auto start = std::chrono::steady_clock::now();
+  {
+    ResultWriter writer{out, options};
+    // this thread runs inputs too while it waits, so it's one of the threads asked for
+    utils::ThreadPool pool{options.threads - 1};
+    utils::TaskGroup group{pool};
+    for (auto i : order) {
+      group.spawn([&, i] {
+        results[i] = solve(day, inputs[i], bytes[i], cache_ptr);
+        writer.write(i, results[i]);
+      });
+    }
+    group.wait();
+  }
+  const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+  if (out != stdout) fclose(out);
+
+  const auto failed = std::count_if(results.begin(), results.end(), [](const result_t& r) { return r.error.has_value(); });
+  const auto mib = std::accumulate(bytes.begin(), bytes.end(), size_t{0}) / double(1 << 20);
+  fmt::println(stderr, "day {}: {} inputs ({:.2f} MiB) in {:.3f} s on {} threads, {:.1f} inputs/s, {:.2f} MiB/s{}",
+      day.number, inputs.size(), mib, wall.count(), options.threads, inputs.size() / wall.count(), mib / wall.count(),
+      failed ? fmt::format(", {} failed", failed) : "");
+  if (cache) {
+    const auto stats = cache->stats();
+    fmt::println(stderr, "answer cache: {} hits, {} misses, {} stored", stats.hits, stats.misses, stats.stores);
+  }
+
+  if constexpr (utils::Tracing) {
+    utils::writeTrace("trace.json");
+    fmt::println(stderr, "trace written to trace.json");
+  }
+  return failed ? 1 : 0;
+}
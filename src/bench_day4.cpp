@@ -2,7 +2,6 @@
 
 #include <benchmark/benchmark.h>
 
-#include <fstream>
 #include <string>
 #include <string_view>
 #include <unordered_set>
@@ -12,7 +11,7 @@
 int cardMatchCount_us(std::string_view line) {
   utils::eatLiteral("Card ", line);
   utils::eatSpaces(line);
-  auto gameId = utils::parseInt(line);
+  utils::parseInt(line); // the game id
   utils::eatLiteral(": ", line);
 
   std::unordered_set<uint8_t> winners;
@@ -24,7 +23,7 @@ int cardMatchCount_us(std::string_view line) {
   uint64_t result = 0;
   while (!line.empty()) {
     if (line.front() == ' ') utils::eatSpaces(line);
-    else if (winners.contains(utils::parseInt(line))) result = ++result;
+    else if (winners.contains(utils::parseInt(line))) ++result;
   }
 
   return result;
@@ -32,7 +31,7 @@ int cardMatchCount_us(std::string_view line) {
 int cardMatchCount_bs(std::string_view line) {
   utils::eatLiteral("Card ", line);
   utils::eatSpaces(line);
-  auto gameId = utils::parseInt(line);
+  utils::parseInt(line); // the game id
   utils::eatLiteral(": ", line);
 
   std::bitset<128> winners;
@@ -46,7 +45,7 @@ int cardMatchCount_bs(std::string_view line) {
   uint64_t result = 0;
   while (!line.empty()) {
     if (line.front() == ' ') utils::eatSpaces(line);
-    else if (winners.test(utils::parseInt(line))) result = ++result;
+    else if (winners.test(utils::parseInt(line))) ++result;
   }
 
   return result;
@@ -56,50 +55,40 @@ int cardValue(int matchCount) {
   return (1 << matchCount) >> 1;
 }
 
-static void BM_cmc_bs(benchmark::State& state) {
-
-  std::string l;
-  for (auto _ : state)
-  {
-    // std::ifstream file("inp/day4_test.txt");
-    std::ifstream file("inp/day4.txt");
-    uint64_t p1 = 0;
-    while (std::getline(file, l)) {
-      auto matches = cardMatchCount_bs(l);
-      p1 += cardValue(matches);
-    }
-  }
+// Read once, so only the card parsing is timed
+static std::string_view input() {
+  // static utils::LineReader lr{"inp/day4_test.txt"};
+  static utils::LineReader lr{"inp/day4.txt"};
+  return lr.contents();
 }
 
-static void BM_cmc_us(benchmark::State& state) {
+static void BM_cmc_bs(benchmark::State& state) {
 
-  std::string l;
   for (auto _ : state)
   {
-    // std::ifstream file("inp/day4_test.txt");
-    std::ifstream file("inp/day4.txt");
+    auto inp = input();
     uint64_t p1 = 0;
-    while (std::getline(file, l)) {
-      auto matches = cardMatchCount_us(l);
+    while (auto l = utils::getLine(inp)) {
+      auto matches = cardMatchCount_bs(*l);
       p1 += cardValue(matches);
     }
+    benchmark::DoNotOptimize(p1);
   }
 }
 
-static void BM_cmc_lr(benchmark::State& state) {
+static void BM_cmc_us(benchmark::State& state) {
 
   for (auto _ : state)
   {
-    // std::ifstream file("inp/day4_test.txt");
-    auto lr = utils::LineReader("inp/day4.txt");
+    auto inp = input();
     uint64_t p1 = 0;
-    while (auto l = lr.getLine()) {
-      auto matches = cardMatchCount_bs(*l);
+    while (auto l = utils::getLine(inp)) {
+      auto matches = cardMatchCount_us(*l);
       p1 += cardValue(matches);
     }
+    benchmark::DoNotOptimize(p1);
   }
 }
 BENCHMARK(BM_cmc_us);
 BENCHMARK(BM_cmc_bs);
-BENCHMARK(BM_cmc_lr);
 BENCHMARK_MAIN();
@@ -0,0 +1,180 @@
+#include "inputgen.hpp"
+#include "perf.hpp"
+#include "registry.hpp"
+#include "utils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <any>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Every day linked in, with parse and each part timed on their own. Inputs are read once
+// up front so none of the file I/O ends up in the numbers, and the parts share a single
+// parse of their input since they leave it as they found it.
+//
+//   bench_days --benchmark_filter=day17 --benchmark_out=bench.json --benchmark_out_format=json
+//
+// With --sweep each day is also run on generated inputs from a quarter to four times the
+// size of a real one, and google benchmark fits how the time grows with the scale.
+//
+// Days that can write snapshots also get a dayN/load benchmark, of mapping a snapshot of
+// their input back in, to put next to dayN/parse.
+//
+// Where perf counters are permitted each benchmark also reports IPC, cache misses per
+// thousand instructions and the branch miss rate, counted on the benchmark's own thread.
+
+struct fixture_t {
+  const utils::Day* day;
+  std::unique_ptr<utils::LineReader> reader;
+  std::any parsed;
+  std::string snapshot; // where it's written, for days that can
+};
+
+// Counts the benchmark loop in the scope it's in and adds what it found to the state's
+// counters. Leaves them out entirely when perf isn't available.
+class CountedLoop {
+  public:
+  explicit CountedLoop(benchmark::State& state) : state_(state) { counters().start(); }
+  CountedLoop(const CountedLoop&) = delete;
+  CountedLoop& operator=(const CountedLoop&) = delete;
+  ~CountedLoop() {
+    const auto sample = counters().stop();
+    const auto add = [this](const char* name, std::optional<double> value) {
+      if (value) state_.counters[name] = *value;
+    };
+    add("IPC", sample.ipc());
+    add("L1d/ki", sample.l1dMpki());
+    add("LLC/ki", sample.llcMpki());
+    add("br-miss", sample.branchMissRate());
+  }
+
+  private:
+  static utils::PerfCounters& counters() {
+    static utils::PerfCounters counters;
+    return counters;
+  }
+
+  benchmark::State& state_;
+};
+
+static void BM_parse(benchmark::State& state, const fixture_t* f) {
+  const auto input = f->reader->contents();
+  CountedLoop counted{state};
+  for (auto _ : state) {
+    auto parsed = f->day->parse(input);
+    benchmark::DoNotOptimize(parsed);
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static void BM_load(benchmark::State& state, const fixture_t* f) {
+  CountedLoop counted{state};
+  for (auto _ : state) {
+    auto parsed = utils::loadSnapshot(*f->day, f->snapshot);
+    benchmark::DoNotOptimize(parsed);
+  }
+  // the text's size, so the rate compares with parsing it
+  state.SetBytesProcessed(state.iterations() * f->reader->contents().size());
+}
+
+static void BM_part(benchmark::State& state, const fixture_t* f,
+    const std::function<std::string(const std::any&)>* part) {
+  CountedLoop counted{state};
+  for (auto _ : state) {
+    auto answer = (*part)(f->parsed);
+    benchmark::DoNotOptimize(answer);
+  }
+}
+
+// Generated inputs are made and parsed the first time each size comes up, and kept so
+// the views into them stay good
+struct generated_t {
+  std::string text;
+  std::any parsed;
+};
+
+static const generated_t& generated(const utils::Day& day, size_t scale) {
+  static std::map<std::pair<int, size_t>, generated_t> cache;
+  auto [it, added] = cache.try_emplace({day.number, scale});
+  if (added) {
+    it->second.text = utils::generateInput(day.number, scale);
+    it->second.parsed = day.parse(it->second.text);
+  }
+  return it->second;
+}
+
+static void BM_sweep_parse(benchmark::State& state, const utils::Day* day) {
+  const std::string_view input = generated(*day, state.range(0)).text;
+  CountedLoop counted{state};
+  for (auto _ : state) {
+    auto parsed = day->parse(input);
+    benchmark::DoNotOptimize(parsed);
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_sweep_part(benchmark::State& state, const utils::Day* day,
+    const std::function<std::string(const std::any&)>* part) {
+  const auto& parsed = generated(*day, state.range(0)).parsed;
+  CountedLoop counted{state};
+  for (auto _ : state) {
+    auto answer = (*part)(parsed);
+    benchmark::DoNotOptimize(answer);
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void registerSweeps() {
+  for (const auto& [n, day] : utils::days()) {
+    const auto& gen = utils::gen::generators()[n - 1];
+    if (!gen.scales) continue;
+    const auto sweep = [&gen](benchmark::internal::Benchmark* b) {
+      // several days split their work over the pool, so CPU time would undercount
+      b->RangeMultiplier(2)->Range(std::max<size_t>(gen.base / 4, 1), gen.base * 4)->UseRealTime()->Complexity();
+    };
+    sweep(benchmark::RegisterBenchmark(fmt::format("day{}/parse/sweep", n).c_str(), BM_sweep_parse, &day));
+    sweep(benchmark::RegisterBenchmark(fmt::format("day{}/part1/sweep", n).c_str(), BM_sweep_part, &day, &day.part1));
+    if (day.part2)
+      sweep(benchmark::RegisterBenchmark(fmt::format("day{}/part2/sweep", n).c_str(), BM_sweep_part, &day, &day.part2));
+  }
+}
+
+int main(int argc, char** argv) {
+  // Take out our own flag before google benchmark sees it
+  auto end = std::remove_if(argv + 1, argv + argc, [](const char* arg) { return std::string_view{arg} == "--sweep"; });
+  const bool sweep = end != argv + argc;
+  argc = end - argv;
+
+  std::vector<std::unique_ptr<fixture_t>> fixtures;
+  for (const auto& [n, day] : utils::days()) {
+    const auto filename = day.defaultInput();
+    if (!std::filesystem::exists(filename)) continue;
+    auto& f = *fixtures.emplace_back(new fixture_t{&day, std::make_unique<utils::LineReader>(filename), {}, {}});
+    f.parsed = day.parse(f.reader->contents());
+
+    benchmark::RegisterBenchmark(fmt::format("day{}/parse", n).c_str(), BM_parse, &f);
+    if (day.save) {
+      f.snapshot = (std::filesystem::temp_directory_path() / fmt::format("bench_day{}.snap", n)).string();
+      utils::saveSnapshot(day, f.parsed, utils::hashBytes(f.reader->contents()), f.snapshot);
+      benchmark::RegisterBenchmark(fmt::format("day{}/load", n).c_str(), BM_load, &f);
+    }
+    benchmark::RegisterBenchmark(fmt::format("day{}/part1", n).c_str(), BM_part, &f, &day.part1);
+    if (day.part2) benchmark::RegisterBenchmark(fmt::format("day{}/part2", n).c_str(), BM_part, &f, &day.part2);
+  }
+
+  if (sweep) registerSweeps();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  for (const auto& f : fixtures) {
+    if (!f->snapshot.empty()) std::filesystem::remove(f->snapshot);
+  }
+}
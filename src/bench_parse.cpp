@@ -0,0 +1,60 @@
+#include "utils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <charconv>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every number in an input file, with whatever followed it so parsers see the real
+// delimiters rather than the end of a view.
+std::vector<std::string_view> collectNumbers(std::string_view inp) {
+  std::vector<std::string_view> result;
+  for (size_t i = 0; i < inp.size(); ++i) {
+    if (std::isdigit(inp[i]) && (i == 0 || !std::isalnum(inp[i - 1]))) result.push_back(inp.substr(i));
+  }
+  return result;
+}
+
+static void BM_from_chars(benchmark::State& state, const std::vector<std::string_view>* numbers) {
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto n : *numbers) {
+      int64_t result = 0;
+      std::from_chars(n.data(), n.data() + n.size(), result);
+      sum += result;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * numbers->size());
+}
+
+static void BM_swar(benchmark::State& state, const std::vector<std::string_view>* numbers) {
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (auto n : *numbers) sum += *utils::tryParseInt(n);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * numbers->size());
+}
+
+int main(int argc, char** argv) {
+  // Readers and number lists need to outlive the benchmarks
+  std::vector<std::unique_ptr<utils::LineReader>> readers;
+  std::vector<std::unique_ptr<std::vector<std::string_view>>> numbers;
+  for (const auto day : {2, 4, 5, 6, 9, 18, 19}) {
+    const auto filename = fmt::format("inp/day{}.txt", day);
+    if (!std::filesystem::exists(filename)) continue;
+    readers.push_back(std::make_unique<utils::LineReader>(filename));
+    numbers.push_back(std::make_unique<std::vector<std::string_view>>(collectNumbers(readers.back()->contents())));
+    benchmark::RegisterBenchmark(fmt::format("BM_from_chars/day{}", day).c_str(), BM_from_chars, numbers.back().get());
+    benchmark::RegisterBenchmark(fmt::format("BM_swar/day{}", day).c_str(), BM_swar, numbers.back().get());
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+}
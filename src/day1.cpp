@@ -1,11 +1,17 @@
 #include <cassert>
-#include <fstream>
 #include <fmt/core.h>
 #include <regex>
 #include <string>
 #include <string_view>
 
-int getCalibrationValuePart1(const std::string& line) {
+#include "days.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
+#include "utils.hpp"
+
+namespace day1 {
+
+int getCalibrationValuePart1(std::string_view line) {
   int ret = (line.at(line.find_first_of("0123456789")) - '0') * 10;
   ret += line.at(line.find_last_of("0123456789")) - '0';
   return ret;
@@ -25,11 +31,11 @@ int matchToVal(std::string_view m) {
   throw std::runtime_error(fmt::format("match wasn't a valid value! m={}", m));
 }
 
-int getCalibrationValuePart2(std::string line) {
-  static std::regex cv_regex("\\d|(one)|(two)|(three)|(four)|(five)|(six)|(seven)|(eight)|(nine)");
+int getCalibrationValuePart2(std::string_view line) {
+  static const std::regex cv_regex("\\d|(one)|(two)|(three)|(four)|(five)|(six)|(seven)|(eight)|(nine)");
   int ret = 0;
   int last = 0;
-  for (std::smatch sm; std::regex_search(line, sm, cv_regex);) {
+  for (std::cmatch sm; std::regex_search(line.begin(), line.end(), sm, cv_regex);) {
     // fmt::println("found match={}", sm.str());
     const auto val = matchToVal(sm.str());
     // The example on cppreference is actually a bit broken. oops!
@@ -45,24 +51,29 @@ void test() {
   assert(getCalibrationValuePart2(l) == 38);
 }
 
-int main(int argc, char **argv) {
+template<typename F>
+uint64_t sumCalibrationValues(std::string_view input, F getCalibrationValue) {
+  return utils::reduceLines(input, uint64_t{0},
+      [getCalibrationValue](uint64_t& sum, std::string_view l) { sum += getCalibrationValue(l); },
+      std::plus<uint64_t>{});
+}
+
+// Nothing worth doing up front, both parts just walk the lines
+std::string_view parse(std::string_view input) {
+  return input;
+}
 
-  // test();
-  std::string l;
-  {
-    // std::ifstream file("inp/day1_test.txt");
-    // std::ifstream file("inp/day1_test2.txt");
-    std::ifstream file("inp/day1.txt");
-    uint64_t sum1 = 0;
-    uint64_t sum2 = 0;
-    while (std::getline(file, l)) {
-      auto calibration_value1 = getCalibrationValuePart1(l);
-      sum1 += calibration_value1;
-      auto calibration_value2 = getCalibrationValuePart2(l);
-      sum2 += calibration_value2;
-      // fmt::println("l={} cv1={} cv2={}", l, calibration_value1, calibration_value2);
-    }
-    fmt::println("Day1: Part 1: {}", sum1);
-    fmt::println("Day1: Part 2: {}", sum2);
-  }
+uint64_t part1(std::string_view input) {
+  return sumCalibrationValues(input, getCalibrationValuePart1);
+}
+
+uint64_t part2(std::string_view input) {
+  return sumCalibrationValues(input, getCalibrationValuePart2);
+}
+
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(1, parse, part1, part2, test, 5);
 }
@@ -1,3 +1,6 @@
+#include "days.hpp"
+#include "grid.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <tuple>
@@ -8,15 +11,15 @@
 #include <string_view>
 #include <set>
 
-using diagram_t = std::vector<std::string_view>;
+namespace day10 {
+// Bordered with ground, which nothing connects to, so looking around S needs no bounds checks
+using diagram_t = utils::Grid2D<char>;
 using coord_t = std::pair<int, int>;
 
 coord_t findStartLocation(const diagram_t& d) {
-  coord_t result;
-  for (int r = 0; r < d.size(); ++r) {
-    for (int c = 0; c < d[r].size(); ++c) {
-      if (d[r][c] == 'S') return {r, c};
-    }
+  for (int r = 0; r < d.height(); ++r) {
+    const auto c = d.line(r).find('S');
+    if (c != std::string_view::npos) return {r, static_cast<int>(c)};
   }
   __builtin_unreachable();
 }
@@ -64,18 +67,18 @@ bool southCompatible(char tile) {
 std::pair<coord_t, coord_t> findFirstSteps(const diagram_t& diagram, coord_t start) {
   coord_t fst = start;
   coord_t snd = start;
-  if (start.first > 0 && northCompatible(diagram[start.first - 1][start.second])) {
+  if (northCompatible(diagram(start.first - 1, start.second))) {
     fst = { start.first - 1, start.second }; 
   }
-  if (start.first < (diagram.size() - 1) && southCompatible(diagram[start.first + 1][start.second])) {
+  if (southCompatible(diagram(start.first + 1, start.second))) {
     auto& tgt = (fst == start) ? fst : snd;
     tgt = { start.first + 1, start.second }; 
   }
-  if (start.second > 0 && westCompatible(diagram[start.first][start.second - 1])) {
+  if (westCompatible(diagram(start.first, start.second - 1))) {
     auto& tgt = (fst == start) ? fst : snd;
     tgt = { start.first, start.second - 1 }; 
   }
-  if (start.second < (diagram[0].size() - 1) && eastCompatible(diagram[start.first][start.second + 1])) {
+  if (eastCompatible(diagram(start.first, start.second + 1))) {
     auto& tgt = (fst == start) ? fst : snd;
     tgt = { start.first, start.second + 1 }; 
   }
@@ -89,8 +92,8 @@ int part1Search(const diagram_t& diagram, coord_t explorer1, coord_t explorer1_p
   if constexpr (Debug) dbgPath.push_back(explorer1);
   if constexpr (Debug) dbgPath.push_back(explorer2);
   while (explorer1 != explorer2) {
-    auto next1 = nextStep(diagram[explorer1.first][explorer1.second], explorer1, explorer1_prev);
-    auto next2 = nextStep(diagram[explorer2.first][explorer2.second], explorer2, explorer2_prev);
+    auto next1 = nextStep(diagram(explorer1.first, explorer1.second), explorer1, explorer1_prev);
+    auto next2 = nextStep(diagram(explorer2.first, explorer2.second), explorer2, explorer2_prev);
     explorer1_prev = explorer1;
     explorer1 = next1;
     explorer2_prev = explorer2;
@@ -107,8 +110,8 @@ void printDbgPath(const diagram_t& diagram, const std::vector<coord_t>& path) {
   std::set<coord_t> pathMap;
   for (const auto c : path) pathMap.insert(c);
 
-  for (int r = 0; r < diagram.size(); ++r) {
-    const auto& row = diagram[r];
+  for (int r = 0; r < diagram.height(); ++r) {
+    const auto row = diagram.line(r);
     for (int c = 0; c < row.size(); ++c) {
       auto color = fmt::color::gray;
       if (row[c] == 'S') color = fmt::color::white;
@@ -121,7 +124,7 @@ void printDbgPath(const diagram_t& diagram, const std::vector<coord_t>& path) {
 }
 
 template<bool Debug>
-int64_t part1(const diagram_t& diagram) {
+int64_t farthestFromStart(const diagram_t& diagram) {
   auto start = findStartLocation(diagram);
   auto [e1, e2] = findFirstSteps(diagram, start);
   if constexpr (Debug) fmt::println("S: ({},{}), searching beginning from ({},{}) and ({},{})", start.first, start.second, e1.first, e1.second, e2.first, e2.second);
@@ -134,18 +137,17 @@ int64_t part1(const diagram_t& diagram) {
 void test() {
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day10_1.txt"};
-  // utils::LineReader lr{"inp/day10_2.txt"};
-  utils::LineReader lr{"inp/day10.txt"};
-  diagram_t diagram;
+diagram_t parse(std::string_view input) {
+  return diagram_t::fromText(input, '.');
+}
 
-  while (auto line = lr.getLine()) {
-    diagram.push_back(*line);
-  }
-  auto p1 = part1<false>(diagram);
-  fmt::println("Day10: Part 1: {}", p1);
-  // auto p2 = part2<false>(instructions, graph);
-  // fmt::println("Day9: Part 2: {}", p2);
+int64_t part1(const diagram_t& diagram) {
+  return farthestFromStart<false>(diagram);
+}
+
+utils::Answers<int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, nullptr);
+}
+
+const bool registered = utils::registerDay(10, parse, part1, nullptr, test);
 }
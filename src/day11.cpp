@@ -1,3 +1,7 @@
+#include "bitgrid.hpp"
+#include "days.hpp"
+#include "grid.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
@@ -9,38 +13,30 @@
 #include <string_view>
 #include <set>
 
-using diagram_t = std::vector<std::string_view>;
+namespace day11 {
+using diagram_t = utils::Grid2D<char>;
+// Galaxies as set bits
+using sky_t = utils::BitGrid;
 using coord_t = std::pair<int64_t, int64_t>;
 
-std::vector<int64_t> findEmptyRows(const diagram_t& d) {
+std::vector<int64_t> findEmptyRows(const sky_t& sky) {
   std::vector<int64_t> result;
-  for (int r = 0; r < d.size(); ++r) {
-    if (std::all_of(d[r].begin(), d[r].end(),
-          [](const auto pix) { return pix == '.'; }))
-      result.push_back(r);
+  for (int r = 0; r < sky.height(); ++r) {
+    if (sky.count(r) == 0) result.push_back(r);
   }
   return result;
 }
 
-std::vector<int64_t> findEmptyCols(const diagram_t& d) {
-  std::vector<int64_t> result;
-  for (int c = 0; c < d[0].size(); ++c) {
-    bool noGalaxies = true;
-    for (int r = 0; r < d.size(); ++r) {
-      noGalaxies &= d[r][c] == '.';
-    }
-    if (noGalaxies) result.push_back(c);
-  }
-  return result;
+// The empty rows of the sky on its side
+std::vector<int64_t> findEmptyCols(const sky_t& sky) {
+  return findEmptyRows(sky.transpose());
 }
 
 std::set<coord_t> buildGalacticMap(const diagram_t& d) {
   std::set<coord_t> result;
-  for (int r = 0; r < d.size(); ++r) {
-    for (int c = 0; c < d[r].size(); ++c) {
-      if (d[r][c] == '#') result.insert({r, c});
-    }
-  }
+  d.forEach([&result](int64_t r, int64_t c, char pix) {
+    if (pix == '#') result.insert({r, c});
+  });
   return result;
 }
 
@@ -53,9 +49,9 @@ int64_t getExpandedCoord(int64_t initial, std::vector<int64_t> expansionIndices,
   return initial + add;
 }
 
-std::set<coord_t> expandGalacticMap(const diagram_t& d, std::set<coord_t>& initial, const int64_t factor) {
-  auto rowExpansions = findEmptyRows(d);
-  auto colExpansions = findEmptyCols(d);
+std::set<coord_t> expandGalacticMap(const sky_t& sky, const std::set<coord_t>& initial, const int64_t factor) {
+  auto rowExpansions = findEmptyRows(sky);
+  auto colExpansions = findEmptyCols(sky);
   std::set<coord_t> result;
 
   for (const auto [r,c] : initial) {
@@ -86,20 +82,25 @@ int64_t getAllShortestPaths(std::set<coord_t>& galaxies) {
 void test() {
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day11_test.txt"};
-  utils::LineReader lr{"inp/day11.txt"};
-  diagram_t diagram;
+struct universe_t {
+  sky_t sky;
+  std::set<coord_t> galaxies;
+};
+
+universe_t parse(std::string_view input) {
+  const auto diagram = diagram_t::fromText(input);
+  return {
+    .sky = sky_t::from(diagram, [](char pix) { return pix == '#'; }),
+    .galaxies = buildGalacticMap(diagram),
+  };
+}
 
-  while (auto line = lr.getLine()) {
-    diagram.push_back(*line);
-  }
-  auto gm = buildGalacticMap(diagram);
-  auto gm_part1 = expandGalacticMap(diagram, gm, 2);
-  auto p1 = getAllShortestPaths(gm_part1);
-  fmt::println("Day11: Part 1: {}", p1);
+int64_t part1(const universe_t& universe) {
+  auto gm_part1 = expandGalacticMap(universe.sky, universe.galaxies, 2);
+  return getAllShortestPaths(gm_part1);
+}
 
+int64_t part2(const universe_t& universe) {
   /*
   {
   auto gm_part2 = expandGalacticMap(diagram, gm, 10);
@@ -112,7 +113,13 @@ int main(int argc, char **argv) {
   fmt::println("Day11: Part 2: 100x={}", p2);
   }
   */
-  auto gm_part2 = expandGalacticMap(diagram, gm, 1000000);
-  auto p2 = getAllShortestPaths(gm_part2);
-  fmt::println("Day11: Part 2: {}", p2);
+  auto gm_part2 = expandGalacticMap(universe.sky, universe.galaxies, 1000000);
+  return getAllShortestPaths(gm_part2);
+}
+
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(11, parse, part1, part2, test);
 }
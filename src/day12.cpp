@@ -1,14 +1,20 @@
+#include "arena.hpp"
+#include "days.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
 #include <tuple>
 #include <deque>
 #include <fmt/format.h>
+#include <memory_resource>
 #include <numeric>
 #include <vector>
 #include <string_view>
 #include <map>
 
+namespace day12 {
 enum class condition {
   operational, // .
   damaged,     // #
@@ -24,15 +30,28 @@ condition parseCond(char c) {
   __builtin_unreachable();
 }
 
+// Allocator-aware so the cache map builds its keys in the same arena. Copies stay in the
+// source's arena too, rather than falling back to the default resource as pmr copies do.
 struct raw_line {
-  std::deque<condition> row;
-  std::deque<int> damaged_runs;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  std::pmr::deque<condition> row;
+  std::pmr::deque<int> damaged_runs;
+
+  explicit raw_line(allocator_type alloc = {}) : row(alloc), damaged_runs(alloc) {}
+  raw_line(const raw_line& other) : raw_line(other, other.row.get_allocator()) {}
+  raw_line(const raw_line& other, allocator_type alloc) : row(other.row, alloc), damaged_runs(other.damaged_runs, alloc) {}
+  raw_line(raw_line&&) = default;
+  raw_line(raw_line&& other, allocator_type alloc) : row(std::move(other.row), alloc), damaged_runs(std::move(other.damaged_runs), alloc) {}
+  raw_line& operator=(const raw_line&) = default;
+  raw_line& operator=(raw_line&&) = default;
+
   bool operator==(const raw_line&) const = default;
   auto operator<=>(const raw_line&) const = default;
 };
 
-raw_line parseRawLine(std::string_view line) {
-  raw_line res;
+raw_line parseRawLine(std::string_view line, std::pmr::memory_resource* mr = std::pmr::get_default_resource()) {
+  raw_line res{mr};
 
   while (line.front() != ' ') {
     auto curr = line.front();
@@ -49,7 +68,7 @@ raw_line parseRawLine(std::string_view line) {
   return res;
 }
 
-std::string fmt_row(const std::deque<condition>& row) {
+std::string fmt_row(const std::pmr::deque<condition>& row) {
   std::string result;
   for (const auto c : row) {
     if (c == condition::damaged) result.push_back('#');
@@ -61,7 +80,7 @@ std::string fmt_row(const std::deque<condition>& row) {
 }
 
 template<bool Debug = false>
-uint64_t calculatePossibilities(std::map<raw_line, uint64_t>& cache, raw_line inp) {
+uint64_t calculatePossibilities(std::pmr::map<raw_line, uint64_t>& cache, raw_line inp) {
   auto [cache_it, unseen]  = cache.emplace(inp, 0);
   auto& result = cache_it->second;
   if constexpr (Debug) fmt::println("calculatePossibilities: {} - {} = {}", fmt_row(inp.row), fmt::join(inp.damaged_runs, ","), result);
@@ -120,26 +139,35 @@ raw_line part2ize(raw_line& inp) {
 void test() {
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day12_test.txt"};
-  utils::LineReader lr{"inp/day12.txt"};
-
-  uint64_t p1 = 0;
-  uint64_t p2 = 0;
-  std::map<raw_line, uint64_t> cache;
-  while (auto line = lr.getLine()) {
-    cache.clear();
-    auto raw_line = parseRawLine(*line);
-    auto res = calculatePossibilities(cache, raw_line);
-    p1 += res;
-
-    raw_line = part2ize(raw_line);
-    res = calculatePossibilities(cache, raw_line);
-    p2 += res;
-
-    // fmt::println("{} -> {}", *line, res);
-  }
-  fmt::println("Day12: Part 1: {}", p1);
-  fmt::println("Day12: Part 2: {}", p2);
+// Every line is its own problem, so they're parsed and solved together on the pool. Each
+// worker has an arena, emptied after every line so the cache and all the intermediate
+// rows go in one go.
+template<bool Unfold>
+uint64_t sumPossibilities(std::string_view input) {
+  return utils::reduceLines(input, uint64_t{0},
+      [](uint64_t& sum, std::string_view line) {
+        thread_local utils::Arena arena;
+        {
+          std::pmr::map<raw_line, uint64_t> cache{&arena};
+          auto raw_line = parseRawLine(line, &arena);
+          if constexpr (Unfold) raw_line = part2ize(raw_line);
+          auto res = calculatePossibilities(cache, raw_line);
+          sum += res;
+          // fmt::println("{} -> {}", line, res);
+        }
+        if constexpr (utils::ArenaStats) arena.report(fmt::format("Day12: {}", line));
+        arena.reset();
+      },
+      std::plus<uint64_t>{});
+}
+
+std::string_view parse(std::string_view input) {
+  return input;
+}
+
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, sumPossibilities<false>, sumPossibilities<true>);
+}
+
+const bool registered = utils::registerDay(12, parse, sumPossibilities<false>, sumPossibilities<true>, test, 40);
 }
@@ -1,4 +1,9 @@
+#include "bitgrid.hpp"
+#include "days.hpp"
+#include "grid.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
 #include <algorithm>
 #include <tuple>
@@ -9,84 +14,79 @@
 #include <string_view>
 #include <map>
 
-using pattern_t = std::vector<std::string_view>;
+namespace day13 {
+// Rocks as set bits, along with the pattern turned on its side so vertical lines of
+// reflection can be found the same way as horizontal ones, comparing rows a word at a time
+struct pattern_t {
+  utils::BitGrid rows;
+  utils::BitGrid cols;
+};
 
-// now return the distance between the two values
-int checkReflection(std::string_view line, int idx) {
-  int left = idx + 1;
-  int right = idx;
-  int reflection = 0;
-
-  while (--left >= 0 && ++right < line.size()) {
-    reflection += (line[left] != line[right]);
-  }
-  return reflection;
-}
-
-int distance(std::string_view l1, std::string_view l2) {
-  int distance = 0;
-  for (int i = 0; i < l1.size(); ++i) {
-    distance += (l1[i] != l2[i]);
-  }
-  return distance;
+pattern_t makePattern(const utils::Grid2D<char>& grid) {
+  auto rows = utils::BitGrid::from(grid, [](char c) { return c == '#'; });
+  auto cols = rows.transpose();
+  return {.rows = std::move(rows), .cols = std::move(cols)};
 }
 
+// How many rows are above the line of reflection that needs exactly SmudgeFactor cells
+// fixing, or 0 if there isn't one
 template<int SmudgeFactor, bool Debug = false>
-uint64_t findReflection(const pattern_t& pattern) {
-  if constexpr (Debug) fmt::println("findReflection<{}> called:\n\t{}", SmudgeFactor, fmt::join(pattern, "\n\t"));
-  // search for horizontal reflection
-  for (int i = 0; i < pattern.size() - 1; ++i) {
+uint64_t findMirror(const utils::BitGrid& bits) {
+  const int height = bits.height();
+  for (int i = 0; i < height - 1; ++i) {
     int top = i+1;
     int bottom = i;
     int smudges = 0;
-    while (smudges <= SmudgeFactor && --top >= 0 && ++bottom < pattern.size()) {
-      smudges += distance(pattern[bottom], pattern[top]);
-    }
-    if constexpr (Debug) if (smudges == SmudgeFactor) fmt::println("findReflection: horizontal: i={}", i);
-    if (smudges == SmudgeFactor) return 100 * (i + 1);
-  }
-
-  const int width = pattern[0].size();
-  // find a vertical line of reflection
-  for (int i = 0; i < width - 1; ++i) {
-    int smudges = 0;
-    for (int r = 0; r < pattern.size(); ++r) {
-      smudges += checkReflection(pattern[r], i);
-      if (smudges > SmudgeFactor) break;
+    while (smudges <= SmudgeFactor && --top >= 0 && ++bottom < height) {
+      smudges += bits.distance(bottom, top);
     }
-    if constexpr (Debug) if (smudges == SmudgeFactor) fmt::println("findReflection: vertical: i={}", i);
+    if constexpr (Debug) if (smudges == SmudgeFactor) fmt::println("findMirror: i={}", i);
     if (smudges == SmudgeFactor) return i + 1;
   }
-
   return 0;
 }
 
+template<int SmudgeFactor, bool Debug = false>
+uint64_t findReflection(const pattern_t& pattern) {
+  if constexpr (Debug) fmt::println("findReflection<{}> called on {}x{}", SmudgeFactor, pattern.rows.width(), pattern.rows.height());
+  // search for horizontal reflection
+  if (auto above = findMirror<SmudgeFactor, Debug>(pattern.rows)) return 100 * above;
+  // then a vertical one
+  return findMirror<SmudgeFactor, Debug>(pattern.cols);
+}
+
 void test() {
-  utils::AssertEq(distance("##...##.", "##...##."), 0);
-  utils::AssertEq(distance("##.#.##.", "##...##."), 1);
-  utils::AssertEq(distance("##.#.##.", "#....##."), 2);
+  const auto pattern = makePattern(utils::Grid2D<char>::fromText(
+      "##...##.\n"
+      "##...##.\n"
+      "##.#.##.\n"
+      "#....##.\n"));
+  utils::AssertEq(pattern.rows.distance(0, 1), 0ul);
+  utils::AssertEq(pattern.rows.distance(1, 2), 1ul);
+  utils::AssertEq(pattern.rows.distance(2, 3), 2ul);
+  utils::AssertEq(pattern.cols.distance(0, 1), 1ul);
+  utils::AssertEq(findReflection<0>(makePattern(utils::Grid2D<char>::fromText(""))), 0ul);
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day13_test.txt"};
-  utils::LineReader lr{"inp/day13.txt"};
+using patterns_t = std::vector<pattern_t>;
 
-  uint64_t p1 = 0;
-  uint64_t p2 = 0;
-  pattern_t pat;
-  while (auto line = lr.getLine()) {
-    if (line->empty()) {
-      p1 += findReflection<0>(pat);
-      p2 += findReflection<1>(pat);
-      pat.clear();
-    } else {
-      pat.push_back(*line);
-    }
-  }
-  p1 += findReflection<0>(pat);
-  p2 += findReflection<1>(pat);
+// Patterns are separated by blank lines
+patterns_t parse(std::string_view input) {
+  patterns_t patterns;
+  for (auto block : utils::blocks(input)) patterns.push_back(makePattern(utils::Grid2D<char>::fromText(block)));
+  return patterns;
+}
+
+template<int Smudges>
+uint64_t sumReflections(const patterns_t& patterns) {
+  uint64_t result = 0;
+  for (const auto& pat : patterns) result += findReflection<Smudges>(pat);
+  return result;
+}
+
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, sumReflections<0>, sumReflections<1>);
+}
 
-  fmt::println("Day13: Part 1: {}", p1);
-  fmt::println("Day13: Part 2: {}", p2);
+const bool registered = utils::registerDay(13, parse, sumReflections<0>, sumReflections<1>, test);
 }
@@ -1,6 +1,13 @@
+#include "bitgrid.hpp"
+#include "days.hpp"
+#include "grid.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <tuple>
 #include <deque>
 #include <fmt/format.h>
@@ -9,156 +16,142 @@
 #include <string_view>
 #include <map>
 
-using platform_t = std::vector<std::string>;
+namespace day14 {
+// Round rocks as set bits, turned on their side for north and south so every tilt is
+// along a row. Cube rocks never move, so the runs of cells between them (segments) are
+// worked out once up front for either way round. A tilt counts the rocks in each segment
+// and packs that many against its end, which is a few words of work per segment rather
+// than a rock at a time.
+struct segment_t {
+  uint32_t row;
+  uint32_t from; // columns [from, to)
+  uint32_t to;
+  uint32_t word; // which of the row's words it's in...
+  uint64_t mask; // ...and its bits there, or 0 if it runs over more than one
+};
+
+struct platform_t {
+  utils::BitGrid rocks; // north at row 0 and west at column 0
+  std::vector<segment_t> rowSegments;
+  std::vector<segment_t> columnSegments; // as rows of the transposed grid
+
+  bool operator==(const platform_t& other) const { return rocks == other.rocks; }
+};
+
+// The runs of cells in each row with no cube in them
+std::vector<segment_t> findSegments(const utils::BitGrid& cubes) {
+  std::vector<segment_t> result;
+  const auto add = [&result](uint32_t r, uint32_t from, uint32_t to) {
+    if (from >= to) return;
+    segment_t s{.row = r, .from = from, .to = to, .word = from / 64, .mask = 0};
+    if (from / 64 == (to - 1) / 64) {
+      const uint64_t top = to % 64 ? (uint64_t{1} << (to % 64)) - 1 : ~uint64_t{0};
+      s.mask = top & (~uint64_t{0} << (from % 64));
+    }
+    result.push_back(s);
+  };
+  for (uint32_t r = 0; r < cubes.height(); ++r) {
+    uint32_t from = 0;
+    const auto row = cubes.row(r);
+    for (size_t w = 0; w < row.size(); ++w) {
+      for (auto bits = row[w]; bits; bits &= bits - 1) {
+        const uint32_t cube = w * 64 + std::countr_zero(bits);
+        add(r, from, cube);
+        from = cube + 1;
+      }
+    }
+    add(r, from, cubes.width());
+  }
+  return result;
+}
+
+// The lowest n cells of a run of set bits, for n up to the run's length. A run that ends
+// at the top of the word wraps round to the right answer, as long as the shift is under 64.
+uint64_t lowest(uint64_t mask, unsigned n) {
+  const uint64_t low = mask & -mask;
+  return n < 64 ? (low << n) - low : mask;
+}
 
+platform_t makePlatform(std::string_view input) {
+  const auto grid = utils::Grid2D<char>::fromText(input);
+  const auto cubes = utils::BitGrid::from(grid, [](char c) { return c == '#'; });
+  return {
+    .rocks = utils::BitGrid::from(grid, [](char c) { return c == 'O'; }),
+    .rowSegments = findSegments(cubes),
+    .columnSegments = findSegments(cubes.transpose()),
+  };
+}
 
 template<bool Debug=false>
 uint64_t scorePlatform(const platform_t& platform) {
   uint64_t result = 0;
-  for (int i = 0; i < platform.size(); ++i) {
-    auto rockCount = 0;
-    for (const char c : platform[i]) { rockCount += c == 'O'; }
-    if constexpr (Debug) fmt::println("i={} row={} rc={}", i, platform[i], rockCount);
-    result += rockCount * (platform.size() - i);
+  const auto height = platform.rocks.height();
+  for (size_t i = 0; i < height; ++i) {
+    const auto rockCount = platform.rocks.count(i);
+    if constexpr (Debug) fmt::println("i={} rc={}", i, rockCount);
+    result += rockCount * (height - i);
   }
   return result;
 }
 
-void tiltNorth(platform_t& platform) {
-  const auto width = platform[0].size();
-  const auto height = platform.size();
-
-  for (int c = 0; c < width; ++c) {
-    int nextEmpty = height + 1;
-    for (int r = 0; r < height; ++r) {
-      auto& tile = platform[r][c];
-      switch (tile) {
-        case '#': {
-                    nextEmpty = height + 1;
-                    continue;
-                  }
-        case '.': {
-                    nextEmpty = std::min(r, nextEmpty);
-                    continue;
-                  }
-        case 'O': {
-                    if (r > nextEmpty) {
-                      platform[nextEmpty++][c] = 'O';
-                      tile = '.';
-                    }
-                  }
-      }
+// Rocks roll to the low (Low) or high end of each segment along the grid's rows
+template<bool Low>
+void tilt(utils::BitGrid& rocks, const std::vector<segment_t>& segments) {
+  for (const auto& s : segments) {
+    // Most segments are within a word, and need nothing more than the one
+    if (s.mask) {
+      auto& word = rocks.row(s.row)[s.word];
+      const auto count = std::popcount(word & s.mask);
+      const auto packed = Low ? lowest(s.mask, count) : s.mask & ~lowest(s.mask, std::popcount(s.mask) - count);
+      word = (word & ~s.mask) | packed;
+      continue;
     }
+    const auto count = rocks.count(s.row, s.from, s.to);
+    if (count == 0 || count == s.to - s.from) continue;
+    rocks.fill(s.row, s.from, s.to, false);
+    if constexpr (Low) rocks.fill(s.row, s.from, s.from + count);
+    else rocks.fill(s.row, s.to - count, s.to);
   }
 }
 
-void tiltSouth(platform_t& platform) {
-  const auto width = platform[0].size();
-  const auto height = platform.size();
-
-  for (int c = 0; c < width; ++c) {
-    int nextEmpty = -1;
-    for (int r = height - 1; r >= 0; --r) {
-      auto& tile = platform[r][c];
-      switch (tile) {
-        case '#': {
-                    nextEmpty = -1;
-                    continue;
-                  }
-        case '.': {
-                    nextEmpty = std::max(r, nextEmpty);
-                    continue;
-                  }
-        case 'O': {
-                    if (r < nextEmpty) {
-                      platform[nextEmpty--][c] = 'O';
-                      tile = '.';
-                    }
-                  }
-      }
-    }
-  }
+// North and south go along the transposed rows, so they're tilted there and turned back
+template<bool North>
+void tiltVertical(platform_t& platform) {
+  auto side = platform.rocks.transpose();
+  tilt<North>(side, platform.columnSegments);
+  platform.rocks = side.transpose();
 }
 
-void tiltWest(platform_t& platform) {
-  const auto width = platform[0].size();
-
-  for (auto& row : platform) {
-    int nextEmpty = width + 1;
-    for (int c = 0; c < width; ++c) {
-      auto& tile = row[c];
-      switch (tile) {
-        case '#': {
-                    nextEmpty = width + 1;
-                    continue;
-                  }
-        case '.': {
-                    nextEmpty = std::min(c, nextEmpty);
-                    continue;
-                  }
-        case 'O': {
-                    if (c > nextEmpty) {
-                      row[nextEmpty++] = 'O';
-                      tile = '.';
-                    }
-                  }
-      }
-    }
-  }
-}
+void tiltNorth(platform_t& platform) { tiltVertical<true>(platform); }
+void tiltSouth(platform_t& platform) { tiltVertical<false>(platform); }
 
-void tiltEast(platform_t& platform) {
-  const auto width = platform[0].size();
-
-  for (auto& row : platform) {
-    int nextEmpty = -1;
-    for (int c = width - 1; c >= 0; --c) {
-      auto& tile = row[c];
-      switch (tile) {
-        case '#': {
-                    nextEmpty = -1;
-                    continue;
-                  }
-        case '.': {
-                    nextEmpty = std::max(c, nextEmpty);
-                    continue;
-                  }
-        case 'O': {
-                    if (c < nextEmpty) {
-                      row[nextEmpty--] = 'O';
-                      tile = '.';
-                    }
-                  }
-      }
-    }
-  }
-}
+void tiltWest(platform_t& platform) { tilt<true>(platform.rocks, platform.rowSegments); }
+void tiltEast(platform_t& platform) { tilt<false>(platform.rocks, platform.rowSegments); }
 
 void test() {
-  platform_t testPlat = {
-    "OOOO.#.O..",
-    "OO..#....#",
-    "OO..O##..O",
-    "O..#.OO...",
-    "........#.",
-    "..#....#.#",
-    "..O..#.O.O",
-    "..O.......",
-    "#....###..",
-    "#....#....",
-  };
-
-  platform_t plat = {
-"OOOO.#.O..",
-"OO..#....#",
-"OO..O##..O",
-"O..#.OO...",
-"........#.",
-"..#....#.#",
-"..O..#.O.O",
-"..O.......",
-"#....###..",
-"#....#...."};
+  auto testPlat = makePlatform(
+    "OOOO.#.O..\n"
+    "OO..#....#\n"
+    "OO..O##..O\n"
+    "O..#.OO...\n"
+    "........#.\n"
+    "..#....#.#\n"
+    "..O..#.O.O\n"
+    "..O.......\n"
+    "#....###..\n"
+    "#....#....\n");
+
+  auto plat = makePlatform(
+    "OOOO.#.O..\n"
+    "OO..#....#\n"
+    "OO..O##..O\n"
+    "O..#.OO...\n"
+    "........#.\n"
+    "..#....#.#\n"
+    "..O..#.O.O\n"
+    "..O.......\n"
+    "#....###..\n"
+    "#....#....\n");
   utils::AssertEq(scorePlatform(plat), 136ul);
   tiltNorth(testPlat);
   utils::Assert(plat == testPlat);
@@ -193,41 +186,49 @@ void spinCycle(platform_t& platform) {
   }
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day14_test.txt"};
-  utils::LineReader lr{"inp/day14.txt"};
+platform_t parse(std::string_view input) {
+  return makePlatform(input);
+}
 
-  platform_t platform;
-  while (auto line = lr.getLine()) {
-      platform.push_back(std::string{*line});
+uint64_t part1(platform_t platform) {
+  {
+    utils::TraceScope trace{"tilt"};
+    tiltNorth(platform);
   }
-  auto lastPlatform = platform;
-  tiltNorth(platform);
-  uint64_t p1 = scorePlatform(platform);
+  return scorePlatform(platform);
+}
 
+uint64_t part2(platform_t platform) {
   uint64_t counter = 0;
   uint64_t cycleLength = 0;
-  platform = lastPlatform;
-  std::map<platform_t, uint64_t> cache;
+  // keyed on just the round rocks, since nothing else changes
+  std::map<utils::BitGrid, uint64_t> cache;
   bool checkCache = true;
   const auto TOTAL_SPINS =1000000000;
   while (counter++ < TOTAL_SPINS) {
-    spinCycle(platform);
+    {
+      utils::TraceScope trace{"spin cycle"};
+      spinCycle(platform);
+    }
     auto score = scorePlatform(platform);
-    if (checkCache && cache.contains(platform)) {
-      cycleLength = counter - cache.at(platform);
+    if (checkCache && cache.contains(platform.rocks)) {
+      cycleLength = counter - cache.at(platform.rocks);
       // fmt::println("Found cycle of length {} at counter={}", cycleLength, counter);
       auto skipCycleCount = (TOTAL_SPINS - counter) / cycleLength;
       counter += skipCycleCount * cycleLength;
       checkCache = false;
     } else {
-      cache.insert({platform, counter});
+      cache.insert({platform.rocks, counter});
+      utils::traceCounter("cached platforms", cache.size());
     }
     // fmt::println("{} -> score={}", counter, scorePlatform(platform));
   }
-  uint64_t p2 = scorePlatform(platform);
+  return scorePlatform(platform);
+}
+
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
 
-  fmt::println("Day14: Part 1: {}", p1);
-  fmt::println("Day14: Part 2: {}", p2);
+const bool registered = utils::registerDay(14, parse, part1, part2, test, 20);
 }
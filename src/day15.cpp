@@ -1,10 +1,14 @@
+#include "days.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
 #include <algorithm>
 #include <fmt/format.h>
 #include <vector>
 #include <string_view>
 
+namespace day15 {
 uint8_t calculateHASH(std::string_view sv) {
   uint8_t result = 0;
   for (const char c : sv) {
@@ -17,15 +21,9 @@ uint8_t calculateHASH(std::string_view sv) {
 void test() {
   auto hashhash = calculateHASH("HASH");
   utils::AssertEq(static_cast<int>(hashhash), 52);
-}
-
-std::optional<std::string_view> getSequence(std::string_view& line) {
-  if (line.empty()) return {};
-
-  auto breakidx = line.find(',');
-  std::string_view result = line.substr(0,breakidx);
-  line.remove_prefix(std::min(line.size(), result.size() + 1));
-  return result;
+  utils::AssertEq(std::ranges::distance(utils::split("rn=1,cm-,qp=3", ',')), 3l);
+  utils::AssertEq(std::ranges::distance(utils::split("rn=1,,qp=3,", ',')), 3l);
+  utils::AssertEq(std::ranges::distance(utils::blocks("\na\nb\n\n\n\nc\n\n\n")), 2l);
 }
 
 std::string_view getLabel(std::string_view& line) {
@@ -97,22 +95,29 @@ uint64_t calculateFocusingPower(const boxes_t& boxes) {
   return result;
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day15_test.txt"};
-  utils::LineReader lr{"inp/day15.txt"};
+// The whole input is a single line of steps
+std::string_view parse(std::string_view input) {
+  return *utils::getLine(input);
+}
 
-  uint64_t p1 = 0;
+uint64_t part1(std::string_view line) {
+  uint64_t result = 0;
+  for (auto step : utils::split(line, ',')) {
+    result += calculateHASH(step);
+    // fmt::println("{} becomes {}.", step, calculateHASH(step));
+  }
+  return result;
+}
+
+uint64_t part2(std::string_view line) {
   boxes_t boxes;
+  for (auto step : utils::split(line, ',')) applyStep(boxes, step);
+  return calculateFocusingPower(boxes);
+}
 
-  auto line = lr.getLine();
-  while (auto step = getSequence(*line)) {
-    p1 += calculateHASH(*step);
-    // fmt::println("{} becomes {}.", *step, calculateHASH(*step));
-    applyStep(boxes, *step);
-  }
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
 
-  fmt::println("Day15: Part 1: {}", p1);
-  auto p2 = calculateFocusingPower(boxes);
-  fmt::println("Day15: Part 2: {}", p2);
+const bool registered = utils::registerDay(15, parse, part1, part2, test);
 }
@@ -1,12 +1,22 @@
+#include "days.hpp"
+#include "grid.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <fmt/format.h>
 #include <vector>
 #include <string_view>
 
-using contraption_t = std::vector<std::string_view>;
-using lightfield_t = std::vector<std::vector<uint8_t>>;
+namespace day16 {
+// Bordered with Outside, so a beam leaving the grid lands on that rather than needing
+// its coordinates checked
+using contraption_t = utils::Grid2D<char>;
+constexpr char Outside = 0;
 
 enum class Direction : uint8_t {
   Up  = 1,
@@ -15,184 +25,171 @@ enum class Direction : uint8_t {
   Left = 8,
 };
 
+// Where a beam is, by the contraption's index(), and which way it's going
 struct beam_t {
-  uint8_t row;
-  uint8_t col;
+  size_t at;
   Direction dir;
 };
 
-void initializeLightfield(lightfield_t& lightfield, const contraption_t& contraption) {
-  for (const auto line : contraption) {
-    lightfield.emplace_back(line.size(), 0);
-  }
+// Which ways a beam has passed through each tile (Direction bits, by index()), and every
+// tile that's been lit since the last clear. Clearing only goes back over those, and how
+// many there are is how many tiles are energized.
+struct lightfield_t {
+  std::vector<uint8_t> seen;
+  std::vector<size_t> lit;
+  std::vector<beam_t> pending; // split off beams still to follow, kept for the capacity
+};
+
+lightfield_t initializeLightfield(const contraption_t& contraption) {
+  const auto end = contraption.index(contraption.height(), contraption.width()) + 1;
+  return {.seen = std::vector<uint8_t>(end), .lit = {}, .pending = {}};
 }
 void clearLightfield(lightfield_t& lightfield) {
-  for (auto& line : lightfield) {
-    for (auto& c : line) {
-      c = 0;
-    }
-  }
+  for (const auto at : lightfield.lit) lightfield.seen[at] = 0;
+  lightfield.lit.clear();
 }
 
 [[nodiscard]]
 bool visit(lightfield_t& lightfield, const beam_t beam) {
-  bool alreadyVisited = lightfield[beam.row][beam.col] & static_cast<std::underlying_type<Direction>::type>(beam.dir);
-  lightfield[beam.row][beam.col] |= static_cast<std::underlying_type<Direction>::type>(beam.dir);
-  return alreadyVisited;
+  auto& seen = lightfield.seen[beam.at];
+  const auto dir = static_cast<uint8_t>(beam.dir);
+  if (seen & dir) return true;
+  if (!seen) lightfield.lit.push_back(beam.at);
+  seen |= dir;
+  return false;
 }
 
-void moveBeam(beam_t& beam) {
+void moveBeam(beam_t& beam, size_t stride) {
   using enum Direction;
-  if (beam.dir == Up) --beam.row;
-  if (beam.dir == Down) ++beam.row;
-  if (beam.dir == Left) --beam.col;
-  if (beam.dir == Right) ++beam.col;
+  if (beam.dir == Up) beam.at -= stride;
+  if (beam.dir == Down) beam.at += stride;
+  if (beam.dir == Left) --beam.at;
+  if (beam.dir == Right) ++beam.at;
 }
 
-std::vector<beam_t> interactBeam(beam_t beam, char tile) {
+// Which ways (as Direction bits) a beam going `dir` leaves `tile`: two of them when it
+// hits a splitter side on
+uint8_t interactBeam(Direction dir, char tile) {
   using enum Direction;
+  const auto bits = [](auto... dirs) { return static_cast<uint8_t>((static_cast<uint8_t>(dirs) | ...)); };
   if (tile == '.') {
-    moveBeam(beam);
-    return {beam};
+    return bits(dir);
   } else if (tile == '/') {
-    switch (beam.dir) {
-      case Up: beam.dir = Right; break;
-      case Right: beam.dir = Up; break;
-      case Down: beam.dir = Left; break;
-      case Left: beam.dir = Down; break;
+    switch (dir) {
+      case Up: return bits(Right);
+      case Right: return bits(Up);
+      case Down: return bits(Left);
+      case Left: return bits(Down);
     }
-    moveBeam(beam);
-    return {beam};
   } else if (tile == '\\') {
-    switch (beam.dir) {
-      case Up: beam.dir = Left; break;
-      case Right: beam.dir = Down; break;
-      case Down: beam.dir = Right; break;
-      case Left: beam.dir = Up; break;
+    switch (dir) {
+      case Up: return bits(Left);
+      case Right: return bits(Down);
+      case Down: return bits(Right);
+      case Left: return bits(Up);
     }
-    moveBeam(beam);
-    return {beam};
   } else if (tile == '-') {
-    if (beam.dir == Right || beam.dir == Left) {
-      moveBeam(beam);
-      return {beam};
-    } else {
-      auto beamLeft = beam;
-      beamLeft.dir = Left;
-      moveBeam(beamLeft);
-      auto beamRight = beam;
-      beamRight.dir = Right;
-      moveBeam(beamRight);
-      return {beamLeft, beamRight};
-    }
+    return dir == Right || dir == Left ? bits(dir) : bits(Left, Right);
   } else if (tile == '|') {
-    if (beam.dir == Up || beam.dir == Down) {
-      moveBeam(beam);
-      return {beam};
-    } else {
-      auto beamUp = beam;
-      beamUp.dir = Up;
-      moveBeam(beamUp);
-      auto beamDown = beam;
-      beamDown.dir = Down;
-      moveBeam(beamDown);
-      return {beamUp, beamDown};
-    }
+    return dir == Up || dir == Down ? bits(dir) : bits(Up, Down);
   }
   __builtin_unreachable();
 }
 
-std::vector<beam_t> stepBeam(const contraption_t& contraption, lightfield_t& lightfield, beam_t beam) {
-  // Only need to check one direction because beam locations are unsigned
-  if (beam.row >= lightfield.size()) return {};
-  if (beam.col >= lightfield[beam.row].size()) return {};
-  // Don't repeat visits we've made
-  if (visit(lightfield, beam)) return {};
-
-  const char tile = contraption[beam.row][beam.col];
-
-  return interactBeam(beam, tile);
-}
-
+// Follows a beam until it leaves the grid or goes somewhere it's been before, and then
+// each beam a splitter sent off the other way, in turn
 void runBeam(const contraption_t& contraption, lightfield_t& lightfield, beam_t initialB) {
-  std::vector<beam_t> current = {initialB};
-  std::vector<beam_t> next;
-  while (!current.empty()) {
-    while (!current.empty()) {
-      auto b = current.back();
-      current.pop_back();
-      auto result = stepBeam(contraption, lightfield, b);
-      next.insert(next.end(), result.begin(), result.end());
+  utils::TraceScope trace{"runBeam"};
+  const auto stride = contraption.stride();
+  auto& pending = lightfield.pending;
+  pending.push_back(initialB);
+  while (!pending.empty()) {
+    auto beam = pending.back();
+    pending.pop_back();
+    while (contraption[beam.at] != Outside && !visit(lightfield, beam)) {
+      auto dirs = interactBeam(beam.dir, contraption[beam.at]);
+      if (std::popcount(dirs) == 2) {
+        beam_t other{beam.at, static_cast<Direction>(dirs & -dirs)};
+        moveBeam(other, stride);
+        pending.push_back(other);
+        dirs &= dirs - 1;
+      }
+      beam.dir = static_cast<Direction>(dirs);
+      moveBeam(beam, stride);
     }
-    current.swap(next);
   }
 }
 
 template<bool Debug>
-uint64_t countEnergizes(const lightfield_t& lightfield) {
-  uint64_t result = 0;
-  for (const auto& row : lightfield) {
-    for (const auto c : row) {
-      if constexpr (Debug) fmt::print("{}", c > 0 ? '#' : '.');
-      result +=  c > 0;
+uint64_t countEnergizes(const contraption_t& contraption, const lightfield_t& lightfield) {
+  const uint64_t result = lightfield.lit.size();
+  if constexpr (Debug) {
+    for (size_t r = 0; r < contraption.height(); ++r) {
+      size_t count = 0;
+      for (size_t c = 0; c < contraption.width(); ++c) {
+        const bool energized = lightfield.seen[contraption.index(r, c)];
+        count += energized;
+        fmt::print("{}", energized ? '#' : '.');
+      }
+      fmt::println(" r:{}", count);
     }
-    if constexpr (Debug) fmt::println(" r:{}", result);
+    fmt::println(" r:{}", result);
   }
-  if constexpr (Debug) fmt::println(" r:{}", result);
   return result;
 }
 
+// Every entrance is independent, so they're shared out over the pool, each run of them
+// reusing one lightfield
 template<bool Debug = false>
-uint64_t checkAllEntrances(const contraption_t& contraption, lightfield_t& lightfield) {
-  uint64_t result = 0;
-
-  for (int r = 0; r < contraption.size(); ++r) {
-    clearLightfield(lightfield);
-    if constexpr (Debug) fmt::println("Checking: {},{} d:{}", r,0,"right");
-    runBeam(contraption, lightfield, beam_t{static_cast<uint8_t>(r), 0, Direction::Right});
-    result = std::max(result, countEnergizes<Debug>(lightfield));
-
-    clearLightfield(lightfield);
-    if constexpr (Debug) fmt::println("Checking: {},{} d:{}", r,contraption[r].size() - 1, "left");
-    runBeam(contraption, lightfield, beam_t{static_cast<uint8_t>(r), static_cast<uint8_t>(contraption[r].size() - 1), Direction::Left});
-    result = std::max(result, countEnergizes<Debug>(lightfield));
+uint64_t checkAllEntrances(const contraption_t& contraption) {
+  const auto width = contraption.width();
+  const auto height = contraption.height();
+  std::vector<beam_t> entrances;
+  for (size_t r = 0; r < height; ++r) {
+    entrances.push_back(beam_t{contraption.index(r, 0), Direction::Right});
+    entrances.push_back(beam_t{contraption.index(r, width - 1), Direction::Left});
   }
-
-  for (int c = 0; c < contraption[0].size(); ++c) {
-    clearLightfield(lightfield);
-    if constexpr (Debug) fmt::println("Checking: {},{} d:{}", 0, c, "down");
-    runBeam(contraption, lightfield, beam_t{0, static_cast<uint8_t>(c), Direction::Down});
-    result = std::max(result, countEnergizes<Debug>(lightfield));
-
-    clearLightfield(lightfield);
-    if constexpr (Debug) fmt::println("Checking: {},{} d:{}", contraption.size() - 1, c, "up");
-    runBeam(contraption, lightfield, beam_t{static_cast<uint8_t>(contraption.size() - 1), static_cast<uint8_t>(c), Direction::Up});
-    result = std::max(result, countEnergizes<Debug>(lightfield));
+  for (size_t c = 0; c < width; ++c) {
+    entrances.push_back(beam_t{contraption.index(0, c), Direction::Down});
+    entrances.push_back(beam_t{contraption.index(height - 1, c), Direction::Up});
   }
-  return result;
+
+  struct best_t {
+    uint64_t energized;
+    lightfield_t lightfield;
+  };
+  const auto best = utils::parallelReduce(0, entrances.size(), best_t{0, initializeLightfield(contraption)},
+      [&](best_t& acc, size_t i) {
+        const auto entrance = entrances[i];
+        clearLightfield(acc.lightfield);
+        if constexpr (Debug) fmt::println("Checking: {} d:{}", entrance.at, static_cast<int>(entrance.dir));
+        runBeam(contraption, acc.lightfield, entrance);
+        acc.energized = std::max(acc.energized, countEnergizes<Debug>(contraption, acc.lightfield));
+      },
+      [](best_t lhs, best_t rhs) { return lhs.energized >= rhs.energized ? std::move(lhs) : std::move(rhs); });
+  return best.energized;
 }
 
 void test() {
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day16_test.txt"};
-  utils::LineReader lr{"inp/day16.txt"};
-
-  contraption_t contraption;
-  while (auto line = lr.getLine()) {
-      contraption.push_back(*line);
-  }
-  lightfield_t lightfield;
-  initializeLightfield(lightfield, contraption);
+contraption_t parse(std::string_view input) {
+  return contraption_t::fromText(input, Outside);
+}
 
-  runBeam(contraption, lightfield, beam_t{0,0,Direction::Right});
-  auto p1 = countEnergizes<false>(lightfield);
+uint64_t part1(const contraption_t& contraption) {
+  lightfield_t lightfield = initializeLightfield(contraption);
+  runBeam(contraption, lightfield, beam_t{contraption.index(0, 0), Direction::Right});
+  return countEnergizes<false>(contraption, lightfield);
+}
 
-  auto p2 = checkAllEntrances(contraption, lightfield);
+uint64_t part2(const contraption_t& contraption) {
+  return checkAllEntrances(contraption);
+}
 
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
 
-  fmt::println("Day16: Part 1: {}", p1);
-  fmt::println("Day16: Part 2: {}", p2);
+const bool registered = utils::registerDay(16, parse, part1, part2, test, 40);
 }
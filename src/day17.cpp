@@ -1,3 +1,7 @@
+#include "days.hpp"
+#include "grid.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
@@ -7,6 +11,7 @@
 #include <map>
 #include <queue>
 
+namespace day17 {
 enum class Direction : uint8_t {
   Up  = 1,
   Right = 2,
@@ -16,15 +21,17 @@ enum class Direction : uint8_t {
 
 struct state_t {
   int32_t heat_loss;
-  uint8_t row;
-  uint8_t col;
+  int16_t row; // room for grids well past the real 141x141, and for the border
+  int16_t col;
   Direction dir;
   uint8_t count;
 
   auto operator<=>(const state_t& state) const = default;
 };
 
-using map_t = std::vector<std::string_view>;
+// Heat loss of each block, bordered with Outside so moves off the edge need no bounds check
+using map_t = utils::Grid2D<uint8_t>;
+constexpr uint8_t Outside = 0;
 using cache_t = std::map<state_t, int32_t>; // state stored with hl=0
 
 [[nodiscard]]
@@ -118,16 +125,12 @@ std::vector<state_t> stepState(const map_t& cityMap, cache_t& cache, state_t sta
   if constexpr (Part == 1) next = nextSteps(state);
   if constexpr (Part == 2) next = nextStepsP2(state);
   for (auto it = next.begin(); it != next.end();) {
-    if (it->row >= cityMap.size()) {
-      it = next.erase(it);
-      continue;
-    }
-    if (it->col >= cityMap[it->row].size()) {
+    const int tile = cityMap(it->row, it->col);
+    if (tile == Outside) {
       it = next.erase(it);
       continue;
     }
 
-    const int tile = cityMap[it->row][it->col] - '0';
     it->heat_loss -= tile;
     ++it;
   }
@@ -140,9 +143,10 @@ void addToQ(std::vector<state_t>& vec, std::priority_queue<state_t>& q) {
 
 template<int Part>
 int64_t runSearch(const map_t& map, cache_t& cache) {
+  utils::TraceScope trace{"runSearch part {}", Part};
   const auto initialLoss = 0;
-  const auto goalRow = map.size() - 1;
-  const auto goalCol = map.back().size() - 1;
+  const int goalRow = map.height() - 1;
+  const int goalCol = map.width() - 1;
 
   std::vector<state_t> next = {state_t{initialLoss,0,0,Direction::Right,0}, state_t{initialLoss,0,0,Direction::Down, 0}};
   std::priority_queue<state_t> q;
@@ -153,7 +157,10 @@ int64_t runSearch(const map_t& map, cache_t& cache) {
     q.pop();
     next = stepState<Part>(map, cache, s);
     for (const auto& s : next) {
-      if (s.row == goalRow && s.col == goalCol) return -(s.heat_loss);
+      if (s.row == goalRow && s.col == goalCol) {
+        utils::traceCounter("states visited", cache.size());
+        return -(s.heat_loss);
+      }
     }
     addToQ(next, q);
   }
@@ -163,21 +170,19 @@ int64_t runSearch(const map_t& map, cache_t& cache) {
 void test() {
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day17_test.txt"};
-  utils::LineReader lr{"inp/day17.txt"};
+map_t parse(std::string_view input) {
+  return map_t::fromText(input, Outside, [](char c) { return static_cast<uint8_t>(c - '0'); });
+}
 
-  map_t cityMap;
-  while (auto line = lr.getLine()) {
-      cityMap.push_back(*line);
-  }
+template<int Part>
+int64_t minimumHeatLoss(const map_t& map) {
   cache_t cache;
+  return runSearch<Part>(map, cache);
+}
 
-  auto p1 = runSearch<1>(cityMap, cache);
-  cache.clear();
-  auto p2 = runSearch<2>(cityMap, cache);
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, minimumHeatLoss<1>, minimumHeatLoss<2>);
+}
 
-  fmt::println("Day17: Part 1: {}", p1);
-  fmt::println("Day17: Part 2: {}", p2);
+const bool registered = utils::registerDay(17, parse, minimumHeatLoss<1>, minimumHeatLoss<2>, test, 100);
 }
@@ -1,3 +1,6 @@
+#include "days.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
@@ -5,6 +8,7 @@
 #include <vector>
 #include <string_view>
 
+namespace day18 {
 enum class Direction : uint8_t {
   Up  = 1,
   Right = 2,
@@ -44,9 +48,10 @@ instn_t parseInstruction1(std::string_view& line) {
   return result;
 }
 
-// must be called after parseInstruction1
+// only looks at the colour, so works on the whole line or what parseInstruction1 left
 instn_t parseInstruction2(std::string_view line) {
   instn_t result;
+  line.remove_prefix(line.find('('));
   utils::AssertEq(line.back(), ')');
   line.remove_suffix(1);
   if (line.back() == '3') result.d = Direction::Up;
@@ -66,39 +71,50 @@ class AreaFinder {
       auto lastCur = m_cursor;
       m_cursor = moveCursor(inst, m_cursor);
       // fmt::println("i={},{} last={},{} new={},{}", fmt::underlying(inst.d), inst.count, lastCur.column, lastCur.row, m_cursor.column, m_cursor.row);
-      m_running_total += (lastCur.column * m_cursor.row - lastCur.row * m_cursor.column);
+      m_running_total += cross(lastCur, m_cursor);
       m_running_total += inst.count;
     }
+    // Appends the instructions seen by rhs after ours. rhs started from (0,0) rather than
+    // our cursor, but the shoelace terms are linear in the offset so we can patch them up
+    // with a single cross product against rhs's total displacement.
+    AreaFinder& operator+=(const AreaFinder& rhs) {
+      m_running_total += rhs.m_running_total + cross(m_cursor, rhs.m_cursor);
+      m_cursor.row += rhs.m_cursor.row;
+      m_cursor.column += rhs.m_cursor.column;
+      return *this;
+    }
     int64_t finalize() {
       utils::AssertEq(m_cursor.row, 0l);
       utils::AssertEq(m_cursor.column, 0l);
-      return std::abs(m_running_total / 2);
+      return std::abs((m_running_total + 2) / 2);
     }
   private:
+    static int64_t cross(const cursor_t& a, const cursor_t& b) {
+      return a.column * b.row - a.row * b.column;
+    }
     cursor_t m_cursor{0,0};
-    int64_t m_running_total = 2;
+    int64_t m_running_total = 0;
 };
 
 void test() {
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day18_test.txt"};
-  utils::LineReader lr{"inp/day18.txt"};
+// Nothing worth doing up front, both parts just walk the lines
+std::string_view parse(std::string_view input) {
+  return input;
+}
 
-  AreaFinder af1;
-  AreaFinder af2;
-  while (auto line = lr.getLine()) {
-    auto inst = parseInstruction1(*line);
-    auto inst2 = parseInstruction2(*line);
-    af1.addPoint(inst);
-    af2.addPoint(inst2);
-  }
+template<auto ParseInstruction>
+int64_t lagoonSize(std::string_view input) {
+  auto af = utils::reduceLines(input, AreaFinder{},
+      [](AreaFinder& acc, std::string_view line) { acc.addPoint(ParseInstruction(line)); },
+      [](AreaFinder l, const AreaFinder& r) { return l += r; });
+  return af.finalize();
+}
 
-  auto p1 = af1.finalize();
-  auto p2 = af2.finalize();
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, lagoonSize<parseInstruction1>, lagoonSize<parseInstruction2>);
+}
 
-  fmt::println("Day18: Part 1: {}", p1);
-  fmt::println("Day18: Part 2: {}", p2);
+const bool registered = utils::registerDay(18, parse, lagoonSize<parseInstruction1>, lagoonSize<parseInstruction2>, test);
 }
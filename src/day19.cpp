@@ -1,20 +1,50 @@
+#include "days.hpp"
+#include "intern.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
+#include <algorithm>
 #include <fmt/format.h>
-#include <unordered_map>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <vector>
 #include <string_view>
 
+namespace day19 {
+// Workflows go by number rather than by name, A and R first and then the rest in the order
+// they come up
+using wf_id = uint32_t;
+constexpr wf_id Accept = 0;
+constexpr wf_id Reject = 1;
+
+class workflow_ids_t {
+  public:
+  workflow_ids_t() {
+    id("A");
+    id("R");
+  }
+  wf_id id(std::string_view name) { return ids_.intern(name); }
+  size_t size() const { return ids_.size(); }
+
+  private:
+  utils::InternTable ids_;
+};
+
 struct rule_t {
   char rating;
   char comp;
+  char unused[2]; // zeroed, since rules are saved into snapshots byte for byte
   int num;
-  std::string target_wf;
+  wf_id target;
 };
 
+// Where a workflow's rules are in the list of everyone's
 struct workflow_t {
-  std::string name;
-  std::vector<rule_t> rules;
+  uint32_t first;
+  uint32_t last;
 };
 
 struct ratings_t {
@@ -24,15 +54,13 @@ struct ratings_t {
   int s;
 };
 
-using wfs_t = std::unordered_map<std::string, std::vector<rule_t>>;
-
-rule_t parseRule(std::string_view& line) {
-  rule_t result;
+rule_t parseRule(std::string_view& line, workflow_ids_t& ids) {
+  rule_t result{};
 
   std::string_view rule_part = line;
   auto comma = rule_part.find(',');
   if (comma == rule_part.npos) {
-    utils::AssertEq(rule_part.back(), '}');
+    utils::Assert(rule_part.ends_with('}'));
     rule_part.remove_suffix(1);
     line.remove_prefix(line.size());
   } else {
@@ -42,8 +70,10 @@ rule_t parseRule(std::string_view& line) {
   }
 
   if (auto colon_pos = rule_part.find(':'); colon_pos == rule_part.npos) {
-    result.rating = 'x'; result.comp = '>'; result.num = -1; result.target_wf = rule_part;
+    result.rating = 'x'; result.comp = '>'; result.num = -1; result.target = ids.id(rule_part);
   } else {
+    // a rating and a comparison before the number, or ruleMatches has nothing to go on
+    utils::Assert(rule_part.size() > 2 && std::string_view{"xmas"}.contains(rule_part[0]) && (rule_part[1] == '<' || rule_part[1] == '>'));
     result.rating = rule_part.front();
     rule_part.remove_prefix(1);
     result.comp = rule_part.front();
@@ -51,38 +81,28 @@ rule_t parseRule(std::string_view& line) {
     result.num = utils::parseInt(rule_part);
     utils::Assert(utils::eatLiteral(":", rule_part));
 
-    result.target_wf = rule_part;
+    result.target = ids.id(rule_part);
   }
   return result;
 }
 
-workflow_t parseWorkflow(std::string_view line) {
-  workflow_t result;
+// Adds the workflow's rules onto `rules` and says which one it was
+wf_id parseWorkflow(std::string_view line, workflow_ids_t& ids, std::vector<rule_t>& rules) {
   auto brace_pos = line.find('{');
-  result.name = line.substr(0, brace_pos);
+  if (brace_pos == line.npos) throw std::invalid_argument(fmt::format("workflow '{}' has no rules", line));
+  const auto result = ids.id(line.substr(0, brace_pos));
   line.remove_prefix(brace_pos);
   utils::Assert(utils::eatLiteral("{", line));
   while (!line.empty()) {
-    result.rules.push_back(parseRule(line));
+    rules.push_back(parseRule(line, ids));
   }
 
   return result;
 }
 
 ratings_t parsePart(std::string_view line) {
-  ratings_t result;
-  utils::Assert(utils::eatLiteral("{x=", line));
-  result.x = utils::parseInt(line);
-  utils::Assert(utils::eatLiteral(",m=", line));
-  result.m = utils::parseInt(line);
-  utils::Assert(utils::eatLiteral(",a=", line));
-  result.a = utils::parseInt(line);
-  utils::Assert(utils::eatLiteral(",s=", line));
-  result.s = utils::parseInt(line);
-  utils::Assert(utils::eatLiteral("}", line));
-  utils::Assert(line.empty());
-
-  return result;
+  auto [x, m, a, s] = utils::scan<"{x={},m={},a={},s={}}", int, int, int, int>(line);
+  return {.x = x, .m = m, .a = a, .s = s};
 }
 
 bool ruleMatches(const rule_t& rule, const ratings_t& part) {
@@ -99,20 +119,6 @@ bool ruleMatches(const rule_t& rule, const ratings_t& part) {
   __builtin_unreachable();
 }
 
-bool acceptPart(const wfs_t& workflows, const ratings_t& part) {
-  std::string current_wf = "in";
-  while (current_wf != "A" && current_wf != "R") {
-    const auto& rules = workflows.at(current_wf);
-    for (const auto& rule : rules) {
-      if (ruleMatches(rule, part)) {
-        current_wf =  rule.target_wf;
-        break;
-      }
-    }
-  }
-  return current_wf == "A";
-}
-
 int64_t totalRatings(const ratings_t& part) {
   return part.x + part.m + part.a + part.s;
 }
@@ -130,11 +136,11 @@ struct rating_bounds_t {
 
 struct state_t {
   rating_bounds_t ratings;
-  std::string wf_name;
+  wf_id wf;
 };
 
 bool validState(const state_t& st) {
-  if (st.wf_name == "R") return false;
+  if (st.wf == Reject) return false;
 
   return (st.ratings.x_min <= st.ratings.x_max)
     && (st.ratings.m_min <= st.ratings.m_max)
@@ -144,7 +150,7 @@ bool validState(const state_t& st) {
 
 std::pair<state_t, state_t> splitStateForRule(state_t state, rule_t rule) {
   if (rule.num == -1) {
-    state.wf_name = rule.target_wf;
+    state.wf = rule.target;
     auto state2 = state;
     state2.ratings.m_min = 4001;
     return {state, state2};
@@ -153,14 +159,14 @@ std::pair<state_t, state_t> splitStateForRule(state_t state, rule_t rule) {
     if (rule.comp == '>') {
       auto state2 = state;
       state.ratings.x_min = rule.num + 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.x_max = rule.num;
       return {state, state2};
     }
     else if (rule.comp == '<') {
       auto state2 = state;
       state.ratings.x_max = rule.num - 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.x_min = rule.num;
       return {state, state2};
     }
@@ -169,14 +175,14 @@ std::pair<state_t, state_t> splitStateForRule(state_t state, rule_t rule) {
     if (rule.comp == '>') {
       auto state2 = state;
       state.ratings.m_min = rule.num + 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.m_max = rule.num;
       return {state, state2};
     }
     else if (rule.comp == '<') {
       auto state2 = state;
       state.ratings.m_max = rule.num - 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.m_min = rule.num;
       return {state, state2};
     }
@@ -185,14 +191,14 @@ std::pair<state_t, state_t> splitStateForRule(state_t state, rule_t rule) {
     if (rule.comp == '>') {
       auto state2 = state;
       state.ratings.a_min = rule.num + 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.a_max = rule.num;
       return {state, state2};
     }
     else if (rule.comp == '<') {
       auto state2 = state;
       state.ratings.a_max = rule.num - 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.a_min = rule.num;
       return {state, state2};
     }
@@ -201,14 +207,14 @@ std::pair<state_t, state_t> splitStateForRule(state_t state, rule_t rule) {
     if (rule.comp == '>') {
       auto state2 = state;
       state.ratings.s_min = rule.num + 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.s_max = rule.num;
       return {state, state2};
     }
     else if (rule.comp == '<') {
       auto state2 = state;
       state.ratings.s_max = rule.num - 1;
-      state.wf_name = rule.target_wf;
+      state.wf = rule.target;
       state2.ratings.s_min = rule.num;
       return {state, state2};
     }
@@ -216,17 +222,15 @@ std::pair<state_t, state_t> splitStateForRule(state_t state, rule_t rule) {
   __builtin_unreachable();
 }
 
-std::vector<state_t> nextStates(const std::vector<rule_t>& rules, state_t state) {
-  std::vector<state_t> result;
-  for (const auto rule : rules) {
+// Appends the states reachable from `state` through the rules onto `out`
+void nextStates(std::span<const rule_t> rules, state_t state, std::vector<state_t>& out) {
+  for (const auto& rule : rules) {
     const auto [s1,s2] = splitStateForRule(state, rule);
-    if (validState(s1)) result.push_back(s1);
+    if (validState(s1)) out.push_back(s1);
     if (!validState(s2))
       break;
     state = s2;
   }
-
-  return result;
 }
 
 uint64_t countAcceptance(const state_t state) {
@@ -238,28 +242,75 @@ uint64_t countAcceptance(const state_t state) {
   return result;
 }
 
-uint64_t part2(const wfs_t& workflows) {
-  state_t initial_state = state_t{.ratings=rating_bounds_t{}, .wf_name="in"};
-  std::vector<state_t> q;
-  q.push_back(initial_state);
+// Every workflow's rules one after the other, the workflows (by id) and the parts. The
+// spans point into `storage`, which is either what parse filled in or a snapshot.
+struct system_t {
+  std::shared_ptr<const void> storage;
+  std::span<const rule_t> rules;
+  std::span<const workflow_t> workflows;
+  std::span<const ratings_t> parts;
+  wf_id in;
+
+  std::span<const rule_t> rulesOf(wf_id wf) const {
+    return rules.subspan(workflows[wf].first, workflows[wf].last - workflows[wf].first);
+  }
+};
+
+struct system_storage_t {
+  std::vector<rule_t> rules;
+  std::vector<workflow_t> workflows;
+  std::vector<ratings_t> parts;
+  wf_id in;
+};
+
+bool acceptPart(const system_t& system, const ratings_t& part) {
+  wf_id current_wf = system.in;
+  while (current_wf != Accept && current_wf != Reject) {
+    for (const auto& rule : system.rulesOf(current_wf)) {
+      if (ruleMatches(rule, part)) {
+        current_wf = rule.target;
+        break;
+      }
+    }
+  }
+  return current_wf == Accept;
+}
+
+// Depth first from `initial`, counting the combinations that end up accepted. If `frontier`
+// is given we stop once the stack is that deep and hand the states still on it back instead.
+uint64_t exploreStates(const system_t& system, state_t initial, std::vector<state_t>& q, size_t frontier = 0) {
+  q.push_back(std::move(initial));
   uint64_t result = 0;
-  while (!q.empty()) {
+  while (!q.empty() && (frontier == 0 || q.size() < frontier)) {
     auto state = q.back();
     q.pop_back();
-    if (state.wf_name == "A") {
-      // fmt::println("{} x{}/{} m{}/{} a{}/{} s{}/{}", state.wf_name, state.ratings.x_min, state.ratings.x_max, state.ratings.m_min, state.ratings.m_max, state.ratings.a_min, state.ratings.a_max, state.ratings.s_min, state.ratings.s_max);
+    if (state.wf == Accept) {
+      // fmt::println("{} x{}/{} m{}/{} a{}/{} s{}/{}", state.wf, state.ratings.x_min, state.ratings.x_max, state.ratings.m_min, state.ratings.m_max, state.ratings.a_min, state.ratings.a_max, state.ratings.s_min, state.ratings.s_max);
       // fmt::println("acceptances: {}", countAcceptance(state));
       result += countAcceptance(state);
       continue;
     }
-    const auto& wf = workflows.at(state.wf_name);
-    auto next = nextStates(wf, state);
-    q.insert(q.end(), next.begin(), next.end());
+    nextStates(system.rulesOf(state.wf), state, q);
   }
 
   return result;
 }
 
+// The search splits into disjoint ranges, so once there are enough of them to go round
+// they're each explored on the pool
+uint64_t countAcceptedCombinations(const system_t& system) {
+  state_t initial_state = state_t{.ratings=rating_bounds_t{}, .wf=system.in};
+  std::vector<state_t> frontier;
+  const uint64_t result = exploreStates(system, initial_state, frontier, 4 * utils::ThreadPool::global().size());
+
+  return result + utils::parallelReduce(0, frontier.size(), uint64_t{0},
+      [&](uint64_t& acc, size_t i) {
+        std::vector<state_t> q;
+        acc += exploreStates(system, frontier[i], q);
+      },
+      std::plus<uint64_t>{});
+}
+
 void test() {
   auto part = parsePart("{x=787,m=2655,a=1222,s=2876}");
   utils::AssertEq(part.x, 787);
@@ -268,55 +319,119 @@ void test() {
   utils::AssertEq(part.s, 2876);
 
   using namespace std::literals::string_view_literals;
+  workflow_ids_t ids;
   auto rulestr = "a<2006:qkq,m>2090:A,rfg}"sv;
-  auto r = parseRule(rulestr);
+  auto r = parseRule(rulestr, ids);
   utils::AssertEq(r.rating, 'a');
   utils::AssertEq(r.comp, '<');
   utils::AssertEq(r.num, 2006);
-  utils::Assert(r.target_wf == "qkq");
+  utils::AssertEq(r.target, ids.id("qkq"));
   ratings_t rat = ratings_t{.x=1,.m=1,.a=2000,.s=1};
   utils::Assert(ruleMatches(r, rat));
 
-  r = parseRule(rulestr);
+  r = parseRule(rulestr, ids);
   utils::AssertEq(r.rating, 'm');
   utils::AssertEq(r.comp, '>');
   utils::AssertEq(r.num, 2090);
-  utils::Assert(r.target_wf == "A");
+  utils::AssertEq(r.target, Accept);
 
-  r = parseRule(rulestr);
+  r = parseRule(rulestr, ids);
   utils::AssertEq(r.num, -1);
-  utils::Assert(r.target_wf == "rfg");
+  utils::AssertEq(r.target, ids.id("rfg"));
 
   auto wf_str = "px{a<2006:qkq,m>2090:A,rfg}"sv;
-  auto wf = parseWorkflow(wf_str);
-  utils::Assert(wf.name == "px");
-  utils::Assert(wf.rules.size() == 3);
+  std::vector<rule_t> rules;
+  auto wf = parseWorkflow(wf_str, ids, rules);
+  utils::AssertEq(wf, ids.id("px"));
+  utils::AssertEq(rules.size(), 3ul);
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day19_test.txt"};
-  utils::LineReader lr{"inp/day19.txt"};
-
-  wfs_t workflows;
-  while (auto line = lr.getLine()) {
-    if (line->empty()) break;
-    auto workflow = parseWorkflow(*line);
-    workflows.insert({workflow.name, workflow.rules});
+void parseInto(std::string_view input, system_t& system) {
+  auto storage = utils::reuseStorage<system_storage_t>(system.storage);
+  storage->rules.clear();
+  storage->workflows.clear();
+  storage->parts.clear();
+  workflow_ids_t ids;
+  std::vector<std::pair<wf_id, workflow_t>> defined;
+  // the workflows, then a blank line, then the parts
+  auto blocks = utils::blocks(input);
+  auto block = blocks.begin();
+  for (auto line : utils::lines(*block)) {
+    const uint32_t first = storage->rules.size();
+    const auto wf = parseWorkflow(line, ids, storage->rules);
+    defined.push_back({wf, {.first = first, .last = static_cast<uint32_t>(storage->rules.size())}});
   }
+  storage->in = ids.id("in");
+  // A and R have no rules of their own, and everything else needs some or a part sent
+  // there would go round forever
+  storage->workflows.resize(ids.size(), {0, 0});
+  std::vector<bool> has_rules(ids.size());
+  has_rules[Accept] = has_rules[Reject] = true;
+  for (const auto& [wf, rules] : defined) {
+    if (wf == Accept || wf == Reject || has_rules[wf]) throw std::invalid_argument("a workflow is defined twice");
+    has_rules[wf] = true;
+    storage->workflows[wf] = rules;
+  }
+  if (std::ranges::find(has_rules, false) != has_rules.end()) throw std::invalid_argument("a workflow is sent to but never defined");
 
-  auto p1 = 0l;
-  while (auto line = lr.getLine()) {
-    auto part = parsePart(*line);
-    auto accepted = acceptPart(workflows, part);
-    if (accepted) {
-      // fmt::println("Accepted = {}", *line);
-      p1 += totalRatings(part);
-    }
+  if (++block == blocks.end()) throw std::invalid_argument("there's no blank line before the parts");
+  for (auto line : utils::lines(*block)) storage->parts.push_back(parsePart(line));
+  system = {.storage = storage, .rules = storage->rules, .workflows = storage->workflows,
+    .parts = storage->parts, .in = storage->in};
+}
+
+system_t parse(std::string_view input) {
+  system_t system{};
+  parseInto(input, system);
+  return system;
+}
+
+void save(const system_t& system, utils::SnapshotWriter& writer) {
+  writer.add(system.rules);
+  writer.add(system.workflows);
+  writer.add(system.parts);
+  writer.add(std::span<const wf_id>{&system.in, 1});
+}
+
+system_t load(std::shared_ptr<const utils::Snapshot> snapshot) {
+  system_t system{.storage = snapshot, .rules = snapshot->section<rule_t>(0), .workflows = snapshot->section<workflow_t>(1),
+    .parts = snapshot->section<ratings_t>(2), .in = snapshot->section<wf_id>(3, 1).front()};
+  // everything parse would have thrown on, since a workflow or target out of place means
+  // reading off the end or going round forever
+  const auto count = system.workflows.size();
+  snapshot->check(count > Reject && system.in < count, "there's no in workflow");
+  for (wf_id wf = 0; wf < count; ++wf) {
+    const auto [first, last] = system.workflows[wf];
+    const bool terminal = wf == Accept || wf == Reject;
+    snapshot->check(first <= last && last <= system.rules.size() && (first == last) == terminal,
+        fmt::format("workflow {} has the wrong rules", wf));
+  }
+  for (const auto& rule : system.rules) {
+    snapshot->check(rule.target < count && std::string_view{"xmas"}.contains(rule.rating) && (rule.comp == '<' || rule.comp == '>'),
+        "a rule is malformed");
   }
+  return system;
+}
+
+// Parts are independent once the workflows are known
+int64_t part1(const system_t& system) {
+  return utils::parallelReduce(0, system.parts.size(), int64_t{0},
+      [&system](int64_t& acc, size_t i) {
+        const auto& part = system.parts[i];
+        if (acceptPart(system, part)) acc += totalRatings(part);
+      },
+      std::plus<int64_t>{});
+}
 
-  auto p2 = part2(workflows);
+uint64_t part2(const system_t& system) {
+  return countAcceptedCombinations(system);
+}
+
+utils::Answers<int64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
 
-  fmt::println("Day19: Part 1: {}", p1);
-  fmt::println("Day19: Part 2: {}", p2);
+const bool registered = utils::registerDay(19, parse, part1, part2, test);
+const bool snapshots = utils::registerSnapshot(19, 1, parse, save, load);
+const bool reparses = utils::registerReparse(19, parse, parseInto);
 }
@@ -1,11 +1,17 @@
 #include <cassert>
-#include <fstream>
 #include <fmt/core.h>
 #include <string>
 #include <string_view>
 
+#include "days.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
+#include <vector>
+
+namespace day2 {
+
 struct rgb {
   int r = 0;
   int g = 0;
@@ -26,21 +32,14 @@ bool possible(const rgb& bs) {
   return bs.r <= 12 & bs.g <= 13 & bs.b <= 14;
 }
 
-struct pp {
-  int possible_id;
-  int power;
-
-  pp& operator+=(const pp& rhs) {
-    this->possible_id += rhs.possible_id;
-    this->power += rhs.power;
-    return *this;
-  }
+struct game_t {
+  int id;
+  rgb minballs;
 };
 
-pp part1And2(std::string_view line) {
-  utils::eatLiteral("Game ", line);
-  int gameId = utils::parseInt(line);
-  utils::eatLiteral(": ", line);
+game_t parseGame(std::string_view line) {
+  auto [gameId, rest] = utils::scanTrusted<"Game {}: {}", int, std::string_view>(line);
+  line = rest;
   // fmt::print("Game {}:", gameId);
   rgb minballs;
   while (!line.empty()) {
@@ -62,7 +61,7 @@ pp part1And2(std::string_view line) {
     minballs = combine(minballs, ballset);
   }
   // fmt::println(" -> {}r {}g {}b", minballs.r, minballs.g, minballs.b);
-  return {possible(minballs) ? gameId : 0, minballs.power()};
+  return {gameId, minballs};
 }
 
 void test() {
@@ -74,17 +73,32 @@ void test() {
   assert(res.b == 6);
 }
 
-int main(int argc, char **argv) {
+using games_t = std::vector<game_t>;
 
-  // test();
+games_t parse(std::string_view input) {
+  return utils::reduceLines(input, games_t{},
+      [](games_t& acc, std::string_view l) { acc.push_back(parseGame(l)); },
+      [](games_t l, const games_t& r) {
+        l.insert(l.end(), r.begin(), r.end());
+        return l;
+      });
+}
 
-  std::string l;
-  // std::ifstream file("inp/day2_test.txt");
-  std::ifstream file("inp/day2.txt");
-  pp res{0, 0};
-  while (std::getline(file, l)) {
-    res += part1And2(l);
-  }
-  fmt::println("Day2: Part 1: {}", res.possible_id);
-  fmt::println("Day2: Part 2: {}", res.power);
+int part1(const games_t& games) {
+  int result = 0;
+  for (const auto& g : games) if (possible(g.minballs)) result += g.id;
+  return result;
+}
+
+int part2(const games_t& games) {
+  int result = 0;
+  for (auto g : games) result += g.minballs.power();
+  return result;
+}
+
+utils::Answers<int, int> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(2, parse, part1, part2, test);
 }
@@ -1,15 +1,25 @@
+#include "days.hpp"
+#include "intern.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
+#include <algorithm>
+#include <array>
 #include <deque>
 #include <fmt/format.h>
-#include <unordered_map>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
 #include <vector>
 #include <string_view>
 
-enum class ModType {
+namespace day20 {
+enum class ModType : uint8_t {
   Plain,
-  FlipFlopOff,
-  FlipFlopOn,
+  FlipFlop,
   Conjunction,
 };
 
@@ -18,48 +28,56 @@ enum class Pulse : bool {
   High = true,
 };
 
+// Modules go by number rather than by name, in the order they come up
+using mod_id = uint32_t;
+
+// A line of the input as it's written
+struct module_line_t {
+  std::string_view name;
+  ModType typ = ModType::Plain;
+  std::vector<std::string_view> outputs;
+};
+
+// Where a module's outputs are in the list of everyone's, and where the memory of its
+// inputs starts (for a conjunction)
 struct module_t {
-  std::string name;
   ModType typ;
-  std::unordered_map<std::string, Pulse> inputs;
-  std::vector<std::string> outputs;
+  uint8_t unused[3]; // zeroed, since modules are saved into snapshots byte for byte
+  uint32_t first_output;
+  uint32_t last_output;
+  uint32_t first_input;
+  uint32_t input_count;
+};
+
+// slot is where the input from this connection is remembered
+struct connection_t {
+  mod_id to;
+  uint32_t slot;
 };
 
 struct pulse_t {
-  std::string from;
-  std::string to;
+  mod_id from;
+  mod_id to;
+  uint32_t slot;
   Pulse val;
 };
 
 ModType parseModType(std::string_view& line) {
-  if (utils::eatLiteral("%", line)) return ModType::FlipFlopOff;
+  if (utils::eatLiteral("%", line)) return ModType::FlipFlop;
   else if (utils::eatLiteral("&", line)) return ModType::Conjunction;
   else return ModType::Plain;
 }
 
-module_t parseModule(std::string_view line) {
-  module_t result;
+module_line_t parseModule(std::string_view line) {
+  module_line_t result;
   result.typ = parseModType(line);
   result.name = utils::readWord(line);
   utils::Assert(utils::eatLiteral(" -> ", line));
-  while (!line.empty()) {
-    result.outputs.emplace_back(utils::readToChar(',', line));
-    utils::eatLiteral(", ", line);
-  }
+  for (auto out : utils::tokens(line, ", ")) result.outputs.push_back(out);
 
   return result;
 }
 
-void fixupModuleConnections(std::unordered_map<std::string, module_t>& mods) {
-  for (const auto& [modName, mod] : mods) {
-    for (const auto& outName : mod.outputs) {
-      if (!mods.contains(outName)) 
-        mods.emplace(outName, module_t{outName, ModType::Plain, {}, {}});
-      mods.at(outName).inputs.emplace(modName, Pulse::Low);
-    }
-  }
-}
-
 void test() {
   using namespace std::literals::string_view_literals;
   {
@@ -68,9 +86,9 @@ void test() {
   utils::Assert(mod.name == "broadcaster");
   utils::Assert(mod.typ == ModType::Plain);
   utils::AssertEq(mod.outputs.size(), 3ul);
-  utils::AssertEq(mod.outputs[0], {"a"});
-  utils::AssertEq(mod.outputs[1], {"b"});
-  utils::AssertEq(mod.outputs[2], {"c"});
+  utils::AssertEq(mod.outputs[0], "a"sv);
+  utils::AssertEq(mod.outputs[1], "b"sv);
+  utils::AssertEq(mod.outputs[2], "c"sv);
   }
   {
   auto line = "&inv -> a"sv;
@@ -78,79 +96,123 @@ void test() {
   utils::Assert(mod.name == "inv");
   utils::Assert(mod.typ == ModType::Conjunction);
   utils::AssertEq(mod.outputs.size(), 1ul);
-  utils::AssertEq(mod.outputs[0], {"a"});
+  utils::AssertEq(mod.outputs[0], "a"sv);
   }
 }
 
+// Every module by id, their connections one after the other, and their names one after
+// the other. The spans point into `storage`, which is either what parse filled in or a
+// snapshot.
+struct machine_t {
+  std::shared_ptr<const void> storage;
+  std::span<const module_t> modules;
+  std::span<const connection_t> connections;
+  std::span<const char> names;
+  std::span<const uint32_t> name_ends;
+  mod_id broadcaster;
+  mod_id rm;
+
+  std::span<const connection_t> outputsOf(mod_id m) const {
+    return connections.subspan(modules[m].first_output, modules[m].last_output - modules[m].first_output);
+  }
+  std::string_view name(mod_id m) const {
+    const auto first = m == 0 ? 0 : name_ends[m - 1];
+    return {names.data() + first, name_ends[m] - first};
+  }
+};
+
+struct machine_storage_t {
+  std::vector<module_t> modules;
+  std::vector<connection_t> connections;
+  std::vector<char> names;
+  std::vector<uint32_t> name_ends;
+  std::array<mod_id, 2> named; // broadcaster and rm
+};
+
+// What changes as pulses go round: which flip-flops are on, what every conjunction last
+// heard from each input, and how many of those were low
+struct state_t {
+  std::vector<bool> on;
+  std::vector<Pulse> remembered;
+  std::vector<uint32_t> low_inputs;
+
+  explicit state_t(const machine_t& machine) : on(machine.modules.size()), remembered(machine.connections.size(), Pulse::Low) {
+    for (const auto& mod : machine.modules) low_inputs.push_back(mod.input_count);
+  }
+};
+
+// Stays on the default allocator: it's drained and refilled for every push of the
+// button, which a monotonic arena would never give back
 using pulse_q = std::deque<pulse_t>;
 
-std::vector<pulse_t> deliverPulse(module_t& mod, const pulse_t& p) {
-  std::vector<pulse_t> result;
+// Queues up whatever the module sends on receiving p
+void deliverPulse(const machine_t& machine, state_t& state, const pulse_t& p, pulse_q& result) {
+  const auto send = [&](Pulse val) {
+    for (const auto& out : machine.outputsOf(p.to))
+      result.push_back({.from = p.to, .to = out.to, .slot = out.slot, .val = val});
+  };
+  const auto& mod = machine.modules[p.to];
   if (mod.typ == ModType::Plain) {
-    for (const auto& out : mod.outputs)
-      result.emplace_back(mod.name, out, p.val);
-  } else if (mod.typ == ModType::FlipFlopOff) {
-    if (p.val == Pulse::Low) {
-      mod.typ = ModType::FlipFlopOn;
-      for (const auto& out : mod.outputs)
-        result.emplace_back(mod.name, out, Pulse::High);
-    }
-  } else if (mod.typ == ModType::FlipFlopOn) {
+    send(p.val);
+  } else if (mod.typ == ModType::FlipFlop) {
     if (p.val == Pulse::Low) {
-      mod.typ = ModType::FlipFlopOff;
-      for (const auto& out : mod.outputs)
-        result.emplace_back(mod.name, out, Pulse::Low);
+      state.on[p.to] = !state.on[p.to];
+      send(state.on[p.to] ? Pulse::High : Pulse::Low);
     }
   } else if (mod.typ == ModType::Conjunction) {
-    mod.inputs.at(p.from) = p.val;
-    auto pv = Pulse::Low;
-    for (const auto& [_n, val] : mod.inputs) {
-      if (val == Pulse::Low) pv = Pulse::High;
+    auto& remembered = state.remembered[p.slot];
+    if (remembered != p.val) {
+      p.val == Pulse::High ? --state.low_inputs[p.to] : ++state.low_inputs[p.to];
+      remembered = p.val;
     }
-
-    for (const auto& out : mod.outputs)
-      result.emplace_back(mod.name, out, pv);
+    send(state.low_inputs[p.to] ? Pulse::High : Pulse::Low);
   }
-  return result;
 }
 
-int64_t part1(std::unordered_map<std::string, module_t> mods) {
+// What the button sends. The broadcaster isn't a conjunction, so the slot doesn't matter.
+pulse_t buttonPulse(const machine_t& machine) {
+  return {.from = machine.broadcaster, .to = machine.broadcaster, .slot = 0, .val = Pulse::Low};
+}
+
+int64_t countPulses(const machine_t& machine) {
+  utils::TraceScope trace{"simulation"};
+  state_t state{machine};
   int64_t highs = 0; int64_t lows = 0;
   pulse_q q;
   for (int i = 0; i < 1000; ++i) {
-    q.emplace_back("button", "broadcaster", Pulse::Low);
+    q.push_back(buttonPulse(machine));
     while (!q.empty()) {
       auto pulse = q.front();
       q.pop_front();
       pulse.val == Pulse::High ? ++highs : ++lows;
-      // fmt::println("{} -{}-> {}", pulse.from, (pulse.val == Pulse::High ? "high" : "low"), pulse.to);
-      auto& mod = mods.at(pulse.to);
-      auto morePulses = deliverPulse(mod, pulse);
-      q.insert(q.end(), morePulses.begin(), morePulses.end());
+      // fmt::println("{} -{}-> {}", machine.name(pulse.from), (pulse.val == Pulse::High ? "high" : "low"), machine.name(pulse.to));
+      deliverPulse(machine, state, pulse, q);
     }
   }
 
   return highs * lows;
 }
 
-int64_t part2(std::unordered_map<std::string, module_t> mods) {
+int64_t countButtonPushes(const machine_t& machine) {
+  utils::TraceScope trace{"simulation"};
+  state_t state{machine};
   // Having a look at the graph there are 4 subgraphs that all feed into
   // a conj result (rm). Some slight hinting suggested they might all be
   // counters and the somewhat on-brand implication is that their periods
   // can all be multiplied together to get the result.
   int64_t buttonPushes = 0;
-  const int goalCount = mods.at("broadcaster").outputs.size();
-  std::unordered_map<std::string, uint64_t> periods;
+  std::map<mod_id, uint64_t> periods;
   pulse_q q;
   while (++buttonPushes) {
-    q.emplace_back("button", "broadcaster", Pulse::Low);
+    q.push_back(buttonPulse(machine));
     while (!q.empty()) {
       auto pulse = q.front();
       q.pop_front();
-      if (pulse.to == "rm" && pulse.val == Pulse::High) {
+      if (pulse.to == machine.rm && pulse.val == Pulse::High) {
         if (!periods.contains(pulse.from)) {
-          // fmt::println("bc={} {} -{}-> {}", buttonPushes, pulse.from, (pulse.val == Pulse::High ? "high" : "low"), pulse.to);
+          // fmt::println("bc={} {} -{}-> {}", buttonPushes, machine.name(pulse.from), (pulse.val == Pulse::High ? "high" : "low"), machine.name(pulse.to));
           periods.emplace(pulse.from, buttonPushes);
+          utils::traceCounter("periods found", periods.size());
         }
         if (periods.size() == 4) {
           int64_t result = 1;
@@ -158,53 +220,127 @@ int64_t part2(std::unordered_map<std::string, module_t> mods) {
           return result;
         }
       }
-      auto& mod = mods.at(pulse.to);
-      auto morePulses = deliverPulse(mod, pulse);
-      q.insert(q.end(), morePulses.begin(), morePulses.end());
+      deliverPulse(machine, state, pulse, q);
     }
   }
 
   return buttonPushes;
 }
 
-void dotPart2(const std::unordered_map<std::string, module_t>& mods) {
+void dotPart2(const machine_t& machine) {
   fmt::println("digraph {{ ");
-  for (const auto& [n, mod] : mods) {
-    auto lbl = n;
+  for (mod_id m = 0; m < machine.modules.size(); ++m) {
+    auto lbl = std::string{machine.name(m)};
     auto color = "black";
-    if (mod.typ == ModType::Conjunction) {
+    if (machine.modules[m].typ == ModType::Conjunction) {
       lbl = "&" + lbl;
       color = "green";
     }
-    if (mod.typ == ModType::FlipFlopOff){
+    if (machine.modules[m].typ == ModType::FlipFlop) {
       lbl = "%" + lbl;
       color = "red";
     }
+    std::vector<std::string_view> outputs;
+    for (const auto& out : machine.outputsOf(m)) outputs.push_back(machine.name(out.to));
     fmt::println("node [xlabel=\"{}\", color={}];", lbl, color);
-    fmt::println("{} -> {{{}}};", n, fmt::join(mod.outputs, ", "));
+    fmt::println("{} -> {{{}}};", machine.name(m), fmt::join(outputs, ", "));
   }
 
   fmt::println(" }}");
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day20_test1.txt"};
-  // utils::LineReader lr{"inp/day20_test2.txt"};
-  utils::LineReader lr{"inp/day20.txt"};
+void parseInto(std::string_view input, machine_t& machine) {
+  std::vector<module_line_t> lines;
+  for (auto line : utils::lines(input)) lines.push_back(parseModule(line));
+
+  // Modules that are only ever sent to get ids too, and do nothing with what they get
+  utils::InternTable ids{lines.size() * 2};
+  for (const auto& line : lines) ids.intern(line.name);
+  for (const auto& line : lines) {
+    for (const auto& out : line.outputs) ids.intern(out);
+  }
+  auto storage = utils::reuseStorage<machine_storage_t>(machine.storage);
+  storage->modules.clear();
+  storage->connections.clear();
+  storage->named = {ids.intern("broadcaster"), ids.intern("rm")};
+  storage->names = ids.names();
+  storage->name_ends = ids.nameEnds();
+
+  auto& modules = storage->modules;
+  modules.resize(ids.size(), {.typ = ModType::Plain, .unused = {}, .first_output = 0, .last_output = 0, .first_input = 0, .input_count = 0});
+  for (const auto& line : lines) {
+    for (const auto& out : line.outputs) ++modules[*ids.find(out)].input_count;
+  }
+  for (mod_id m = 1; m < modules.size(); ++m) modules[m].first_input = modules[m - 1].first_input + modules[m - 1].input_count;
 
-  std::unordered_map<std::string, module_t> mods;
-  while (auto line = lr.getLine()) {
-    auto mod = parseModule(*line);
-    mods.insert({mod.name, mod});
+  // Each connection gets the next free slot among its module's inputs
+  std::vector<uint32_t> slots_used(modules.size());
+  for (const auto& line : lines) {
+    auto& mod = modules[*ids.find(line.name)];
+    mod.typ = line.typ;
+    mod.first_output = storage->connections.size();
+    for (const auto& out : line.outputs) {
+      const auto to = *ids.find(out);
+      storage->connections.push_back({.to = to, .slot = modules[to].first_input + slots_used[to]++});
+    }
+    mod.last_output = storage->connections.size();
   }
 
-  fixupModuleConnections(mods);
-  auto p1 = part1(mods);
+  // dotPart2(...);
+  machine = {.storage = storage, .modules = storage->modules, .connections = storage->connections,
+    .names = storage->names, .name_ends = storage->name_ends, .broadcaster = storage->named[0], .rm = storage->named[1]};
+}
+
+machine_t parse(std::string_view input) {
+  machine_t machine{};
+  parseInto(input, machine);
+  return machine;
+}
 
-  // dotPart2(mods);
-  auto p2 = part2(mods);
+void save(const machine_t& machine, utils::SnapshotWriter& writer) {
+  writer.add(machine.modules);
+  writer.add(machine.connections);
+  writer.add(machine.names);
+  writer.add(machine.name_ends);
+  const std::array<mod_id, 2> named = {machine.broadcaster, machine.rm};
+  writer.add(std::span<const mod_id>{named});
+}
+
+machine_t load(std::shared_ptr<const utils::Snapshot> snapshot) {
+  const auto named = snapshot->section<mod_id>(4, 2);
+  machine_t machine{.storage = snapshot, .modules = snapshot->section<module_t>(0), .connections = snapshot->section<connection_t>(1),
+    .names = snapshot->section<char>(2), .name_ends = snapshot->section<uint32_t>(3), .broadcaster = named[0], .rm = named[1]};
+  // every id and offset in range, and each connection's slot among its module's inputs
+  const auto& modules = machine.modules;
+  const auto& connections = machine.connections;
+  snapshot->check(machine.broadcaster < modules.size() && machine.rm < modules.size(), "broadcaster or rm is missing");
+  for (const auto& mod : modules) {
+    snapshot->check(mod.typ <= ModType::Conjunction && mod.first_output <= mod.last_output && mod.last_output <= connections.size() &&
+        mod.first_input <= connections.size() && mod.input_count <= connections.size() - mod.first_input, "a module is malformed");
+  }
+  for (const auto& conn : connections) {
+    snapshot->check(conn.to < modules.size() && conn.slot >= modules[conn.to].first_input &&
+        conn.slot - modules[conn.to].first_input < modules[conn.to].input_count, "a connection is malformed");
+  }
+  const auto& ends = machine.name_ends;
+  snapshot->check(ends.size() == modules.size() && std::ranges::is_sorted(ends) && (ends.empty() || ends.back() == machine.names.size()),
+      "names don't match the modules");
+  return machine;
+}
+
+int64_t part1(const machine_t& machine) {
+  return countPulses(machine);
+}
+
+int64_t part2(const machine_t& machine) {
+  return countButtonPushes(machine);
+}
+
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
 
-  fmt::println("Day20: Part 1: {}", p1);
-  fmt::println("Day20: Part 2: {}", p2);
+const bool registered = utils::registerDay(20, parse, part1, part2, test, 10);
+const bool snapshots = utils::registerSnapshot(20, 1, parse, save, load);
+const bool reparses = utils::registerReparse(20, parse, parseInto);
 }
@@ -1,4 +1,3 @@
-#include <fstream>
 #include <fmt/core.h>
 #include <fmt/color.h>
 #include <string>
@@ -7,42 +6,26 @@
 #include <unordered_map>
 #include <cassert>
 
+#include "days.hpp"
+#include "grid.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
-using schematic = std::vector<std::string>;
+namespace day3 {
+// Bordered with '.', so the cells around a number can all be looked at without bounds checks
+using schematic = utils::Grid2D<char>;
 using gear_map = std::unordered_map<int, std::vector<uint64_t>>;
 
 template<typename P>
 bool check_perimeter(const schematic& map, int row, int n_start_col, int n_len, P pred) {
-  auto start_col = n_start_col == 0 ? 0 : n_start_col - 1;
-  auto end_col = n_start_col + n_len;
-  if (end_col == map[0].size()) --end_col;
-
-  if (row > 0) {
-    --row;
-    const std::string& line = map[row];
-    for (int c = start_col; c <= end_col; ++c) {
-      if (pred(line[c]))
-        return true;
-    }
-    ++row;
-  }
-  if (pred(map[row][start_col])) {
-    return true;
-  }
-  if (pred(map[row][end_col])) {
-    return true;
-  }
+  const auto start_col = n_start_col - 1;
+  const auto end_col = n_start_col + n_len;
 
-  ++row;
-  if (row < map.size()) {
-    const std::string& line = map[row];
-    for (int c = start_col; c <= end_col; ++c) {
-      if (pred(line[c]))
-        return true;
-    }
+  for (int c = start_col; c <= end_col; ++c) {
+    if (pred(map(row - 1, c)) || pred(map(row + 1, c)))
+      return true;
   }
-  return false;
+  return pred(map(row, start_col)) || pred(map(row, end_col));
 }
 
 bool add_gear_part(gear_map& gm, int idx, uint64_t n) {
@@ -53,41 +36,26 @@ bool add_gear_part(gear_map& gm, int idx, uint64_t n) {
 
 bool update_gear_map(const schematic& map, gear_map& gm, int n, int row, int n_start_col, int n_len) {
   bool ret = false;
-  auto start_col = n_start_col == 0 ? 0 : n_start_col - 1;
-  auto end_col = n_start_col + n_len;
-  if (end_col == map[0].size()) --end_col;
-  const auto idx = [&map](auto r, auto c) { return (r * map[0].size() + c); };
-
-  if (row > 0) {
-    const std::string& line = map[row-1];
-    for (int c = start_col; c <= end_col; ++c) {
-      if (line[c] == '*') {
-        ret = add_gear_part(gm, idx(row-1, c), n);
-      }
-    }
-  }
-  if (map[row][start_col] == '*')
-    ret = add_gear_part(gm, idx(row, start_col), n);
-  if (map[row][end_col] == '*')
-    ret = add_gear_part(gm, idx(row, end_col), n);
-
-  if (row + 1 < map.size()) {
-    const std::string& line = map[row+1];
-    for (int c = start_col; c <= end_col; ++c) {
-      if (line[c] == '*')
-        ret = add_gear_part(gm, idx(row+1, c), n);
-    }
-  }
+  const auto start_col = n_start_col - 1;
+  const auto end_col = n_start_col + n_len;
+  const auto check = [&](int r, int c) {
+    if (map(r, c) == '*') ret = add_gear_part(gm, map.index(r, c), n);
+  };
+
+  for (int c = start_col; c <= end_col; ++c) check(row - 1, c);
+  check(row, start_col);
+  check(row, end_col);
+  for (int c = start_col; c <= end_col; ++c) check(row + 1, c);
   return ret;
 }
 
 template<bool debug, typename F, typename G>
 void iterate(const schematic& map, F onNumber, G otherwise) {
   constexpr auto is_gear_part = [](auto c) { return c == '*'; };
-  for (int r = 0; r < map.size(); ++r) {
-    const std::string line = map[r];
+  for (int r = 0; r < map.height(); ++r) {
+    const std::string_view line = map.line(r);
     for (int c = 0; c < line.size(); ) {
-      std::string_view lv = {line.begin() + c, line.end()};
+      std::string_view lv = line.substr(c);
       if (std::isdigit(lv.front())) {
         auto original_sz = lv.size();
         auto n = utils::parseInt(lv);
@@ -95,7 +63,7 @@ void iterate(const schematic& map, F onNumber, G otherwise) {
         onNumber(r, c, n, n_len);
         c += n_len;
       } else {
-        otherwise(line[c], r * line.size() + c);
+        otherwise(line[c], map.index(r, c));
         ++c; }
     }
     if constexpr (debug) fmt::println("");
@@ -176,43 +144,37 @@ uint64_t part2_iter(const schematic& map) {
 void test() {
   auto is_part_number_pred = [](const auto c) { return (c != '.' && !std::isdigit(c)); };
   {
-    schematic m = {{"...440...."},
-                   {"........#."}};
+    auto m = schematic::fromText("...440....\n"
+                                 "........#.", '.');
     utils::AssertEq(check_perimeter(m, 0, 3, 3, is_part_number_pred), false);
   }
   {
-    schematic m = {{"...440#..."},
-                   {"........#."}};
+    auto m = schematic::fromText("...440#...\n"
+                                 "........#.", '.');
     utils::AssertEq(check_perimeter(m, 0, 3, 3, is_part_number_pred), true);
   }
   {
-    schematic m = {{"...440...."},
-                   {"......#.#."}};
+    auto m = schematic::fromText("...440....\n"
+                                 "......#.#.", '.');
     utils::AssertEq(check_perimeter(m, 0, 3, 3, is_part_number_pred), true);
   }
   {
     gear_map gm;
-    schematic m = {{"...209*418.."},
-                   {"............"}};
+    auto m = schematic::fromText("...209*418..\n"
+                                 "............", '.');
     utils::AssertEq(update_gear_map(m, gm, 209, 0, 3, 3), true);
     utils::AssertEq(update_gear_map(m, gm, 418, 0, 7, 3), true);
     utils::AssertEq(gm.size(), 1ul);
   }
 }
 
-int main(int argc, char **argv) {
+schematic parse(std::string_view input) {
+  return schematic::fromText(input, '.');
+}
 
-  test();
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1_iterate<false>, part2_iter<false>);
+}
 
-  schematic map;
-  std::string l;
-  // std::ifstream file("inp/day3_test.txt");
-  std::ifstream file("inp/day3.txt");
-  while (std::getline(file, l)) {
-    map.push_back(std::move(l));
-  }
-  auto p1res = part1_iterate<false>(map);
-  auto p2res = part2_iter<false>(map);
-  fmt::println("Day3: Part 1: {}", p1res);
-  fmt::println("Day3: Part 2: {}", p2res);
+const bool registered = utils::registerDay(3, parse, part1_iterate<false>, part2_iter<false>, test);
 }
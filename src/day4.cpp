@@ -1,29 +1,33 @@
+#include "days.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
-#include <fstream>
+#include <array>
 #include <string>
 #include <string_view>
 #include <unordered_set>
 #include <deque>
 #include <bitset>
 
+namespace day4 {
 int cardMatchCount(std::string_view line) {
   utils::eatLiteral("Card ", line);
   utils::eatSpaces(line);
   auto _gameId = utils::parseInt(line);
   utils::eatLiteral(": ", line);
+  const auto bar = line.find('|');
+  utils::Assert(bar != line.npos);
 
+  // parseInts throws on a card with more numbers than this
+  std::array<int64_t, 64> numbers;
   std::bitset<128> winners;
-  while (line.front() != '|') {
-    if (line.front() == ' ') utils::eatSpaces(line);
-    else winners.set(utils::parseInt(line));
-  }
-  utils::eatChar('|', line);
+  const auto winnerCount = utils::parseInts(line.substr(0, bar), numbers);
+  for (size_t i = 0; i < winnerCount; ++i) winners.set(numbers[i]);
+
   uint64_t result = 0;
-  while (!line.empty()) {
-    if (line.front() == ' ') utils::eatSpaces(line);
-    else if (winners.test(utils::parseInt(line))) result = ++result;
-  }
+  const auto haveCount = utils::parseInts(line.substr(bar + 1), numbers);
+  for (size_t i = 0; i < haveCount; ++i) result += winners.test(numbers[i]);
 
   return result;
 }
@@ -47,25 +51,37 @@ void test() {
   for (const auto v : counts) utils::AssertEq(v, 2ul);
 }
 
-int main(int argc, char **argv) {
+// Cards can be matched independently, but the copies in part 2 have to be counted in order
+std::vector<int> parse(std::string_view input) {
+  return utils::reduceLines(input, std::vector<int>{},
+      [](std::vector<int>& acc, std::string_view l) { acc.push_back(cardMatchCount(l)); },
+      [](std::vector<int> l, const std::vector<int>& r) {
+        l.insert(l.end(), r.begin(), r.end());
+        return l;
+      });
+}
+
+uint64_t part1(const std::vector<int>& allMatches) {
+  uint64_t result = 0;
+  for (const auto matches : allMatches) result += cardValue(matches);
+  return result;
+}
 
-  // test();
-  std::string l;
-  {
-    // std::ifstream file("inp/day4_test.txt");
-    std::ifstream file("inp/day4.txt");
-    uint64_t p1 = 0;
-    uint64_t p2 = 0;
-    std::deque<uint64_t> counts{1};
-    while (std::getline(file, l)) {
-      auto matches = cardMatchCount(l);
-      p1 += cardValue(matches);
-      auto copies = counts.front();
-      p2 += copies;
-      counts.pop_front();
-      extendCounts(counts, copies, matches);
-    }
-    fmt::println("Day4: Part 1: {}", p1);
-    fmt::println("Day4: Part 2: {}", p2);
+uint64_t part2(const std::vector<int>& allMatches) {
+  uint64_t result = 0;
+  std::deque<uint64_t> counts{1};
+  for (const auto matches : allMatches) {
+    auto copies = counts.front();
+    result += copies;
+    counts.pop_front();
+    extendCounts(counts, copies, matches);
   }
+  return result;
+}
+
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(4, parse, part1, part2, test);
 }
@@ -1,23 +1,34 @@
+#include "days.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
 #include <algorithm>
 #include <fmt/format.h>
+#include <memory>
+#include <ranges>
+#include <span>
 #include <vector>
 #include <string>
 #include <string_view>
 
+namespace day5 {
 struct range {
   int64_t start;
   int64_t length;
 };
-template <> struct fmt::formatter<range> {
+}
+
+template <> struct fmt::formatter<day5::range> {
   constexpr auto parse(format_parse_context& ctx) -> format_parse_context::iterator {
     return ctx.end();
   }
-  auto format(const range& r, format_context& ctx) const -> format_context::iterator {
+  auto format(const day5::range& r, format_context& ctx) const -> format_context::iterator {
     return fmt::format_to(ctx.out(), "[{}; {}]", r.start, r.length);
   }
 };
+
+namespace day5 {
 struct range_mapping {
   // the results of applying a mapping to a range have 4 cases
   // 1. the range does not overlap with the mapping at all. 
@@ -80,93 +91,36 @@ range_mapping applyMapping(range n, const mapping& mapping) {
 }
 
 mapping parseMappingLine(std::string_view line) {
-  mapping ret;
-  ret.dest_range_start = utils::parseInt(line);
-  utils::eatChar(' ', line);
-  ret.source_range_start = utils::parseInt(line);
-  utils::eatChar(' ', line);
-  ret.source_range_len = utils::parseInt(line);
-
-  return ret;
+  std::array<int64_t, 3> nums;
+  utils::AssertEq(utils::parseInts(line, nums), nums.size());
+  return {.dest_range_start = nums[0], .source_range_start = nums[1], .source_range_len = nums[2]};
 }
 
 std::vector<int64_t> parseSeeds(std::string_view line) {
-  std::vector<int64_t> result;
   utils::eatLiteral("seeds:", line);
-  while (!line.empty()) {
-    utils::eatChar(' ', line);
-    result.push_back(utils::parseInt(line));
-  }
+  // every number takes at least 2 chars with its separator
+  std::vector<int64_t> result(line.size() / 2 + 1);
+  result.resize(utils::parseInts(line, result));
   return result;
 }
 std::vector<range> parseSeedRanges(std::string_view line) {
+  auto seeds = parseSeeds(line);
   std::vector<range> result;
-  utils::eatLiteral("seeds:", line);
-  while (!line.empty()) {
-    utils::eatChar(' ', line);
-    auto start = utils::parseInt(line);
-    utils::eatChar(' ', line);
-    auto length = utils::parseInt(line);
-    result.push_back({start, length});
+  result.reserve(seeds.size() / 2);
+  for (size_t i = 0; i + 1 < seeds.size(); i += 2) {
+    result.push_back({seeds[i], seeds[i + 1]});
   }
   return result;
 }
 
-template<typename NumberT, bool Debug=false>
-class almanac_runner_t {
-  public:
-    using numbers = std::vector<NumberT>;
-    almanac_runner_t() = default;
-
-    void setInitialNumbers(numbers ns) {
-      next_ = std::move(ns);
-      if constexpr (Debug) fmt::println("seeds: {}", fmt::join(next_, ", "));
-    }
-    numbers getFinalNumbers() { finishMapping(); return current_; }
-
-    void feedLine(std::string_view line) {
-      if (currentMap_ == "") {
-        utils::AssertEq(line.empty(), false);
-        utils::AssertEq(std::isdigit(line.front()), 0);
-        currentMap_ = line;
-      } else if (line == "") {
-        finishMapping();
-        currentMap_ = "";
-      } else {
-        auto m = parseMappingLine(line);
-        runMappingRule(m);
-      }
-    };
-  private:
-    // Finishes a "round" of mapping, putting all values back into current_ ready for the next
-    void finishMapping() {
-      // any numbers which didn't match are reused
-      // just need to add the ones we updated back to current_
-      if constexpr (Debug) {
-        if (!current_.empty())
-          fmt::println("Rule {} left {} unchanged!", currentMap_, fmt::join(current_, ", "));
-      }
-      current_.insert(current_.end(),  next_.begin(), next_.end());
-      next_.clear();
-    }
-
-    void runMappingRule(const mapping m) {
-      mapMappingRule<Debug>(currentMap_, current_, next_, m);
-    };
-
-    std::string currentMap_ = "seeds";
-    numbers current_;
-    numbers next_;
-};
-
 template<bool Debug=false>
-void mapMappingRule(const std::string& ruleType, std::vector<range>& current, std::vector<range>& next, const mapping m) {
+void mapMappingRule(size_t section, std::vector<range>& current, std::vector<range>& next, const mapping m) {
   for (auto idx = 0; idx < current.size(); ) {
     auto mres = applyMapping(current[idx], m);
     if (mres.result.length != 0)
     {
       if constexpr (Debug) {
-        fmt::println("Rule {} mapped {} -> {} (pre={} suf={})", ruleType, current[idx], mres.result, mres.prefix, mres.suffix);
+        fmt::println("Section {} mapped {} -> {} (pre={} suf={})", section, current[idx], mres.result, mres.prefix, mres.suffix);
       }
       next.push_back(mres.result);
       current.erase(current.begin() + idx);
@@ -181,11 +135,11 @@ void mapMappingRule(const std::string& ruleType, std::vector<range>& current, st
 }
 
 template<bool Debug=false>
-void mapMappingRule(const std::string& ruleType, std::vector<int64_t>& current, std::vector<int64_t>& next, const mapping m) {
+void mapMappingRule(size_t section, std::vector<int64_t>& current, std::vector<int64_t>& next, const mapping m) {
   for (auto idx = 0; idx < current.size(); ) {
     if (auto nv = applyMapping(current[idx], m)) {
       if constexpr (Debug) {
-        fmt::println("Rule {} mapped {} -> {}", ruleType, current[idx], *nv);
+        fmt::println("Section {} mapped {} -> {}", section, current[idx], *nv);
       }
       next.push_back(nv.value());
       current.erase(current.begin() + idx);
@@ -205,31 +159,105 @@ void test() {
   utils::AssertEq(sr[1].length, 13l);
 }
 
-int main(int argc, char **argv) {
+// The mappings of every section one after the other, with `sections` saying where each
+// section starts (and then where the last one ends). The spans point into `storage`,
+// which is either what parse filled in or a snapshot.
+struct almanac_t {
+  std::shared_ptr<const void> storage;
+  std::span<const int64_t> seeds;
+  std::span<const range> seedRanges;
+  std::span<const mapping> mappings;
+  std::span<const uint32_t> sections;
+};
 
-  // test();
-  // utils::LineReader lr{"inp/day5_test.txt"};
-  utils::LineReader lr{"inp/day5.txt"};
-  auto seedLine = *lr.getLine();
-  auto seeds = parseSeeds(seedLine);
-  auto seedRanges = parseSeedRanges(seedLine);
+struct almanac_storage_t {
+  std::vector<int64_t> seeds;
+  std::vector<range> seedRanges;
+  std::vector<mapping> mappings;
+  std::vector<uint32_t> sections;
+};
 
-  almanac_runner_t<int64_t, false> alm;
-  almanac_runner_t<range, false> alm_range;
+void parseInto(std::string_view input, almanac_t& almanac) {
+  auto storage = utils::reuseStorage<almanac_storage_t>(almanac.storage);
+  storage->mappings.clear();
+  storage->sections.clear();
+  auto blocks = utils::blocks(input);
+  auto block = blocks.begin();
+  const auto seedLine = *block;
+  storage->seeds = parseSeeds(seedLine);
+  storage->seedRanges = parseSeedRanges(seedLine);
+  // every other block is a section: a line naming it, then its mappings
+  for (auto section : std::ranges::subrange{++block, blocks.end()}) {
+    storage->sections.push_back(storage->mappings.size());
+    for (auto line : utils::lines(section) | std::views::drop(1)) storage->mappings.push_back(parseMappingLine(line));
+  }
+  storage->sections.push_back(storage->mappings.size());
+  almanac = {.storage = storage, .seeds = storage->seeds, .seedRanges = storage->seedRanges,
+    .mappings = storage->mappings, .sections = storage->sections};
+}
+
+almanac_t parse(std::string_view input) {
+  almanac_t almanac{};
+  parseInto(input, almanac);
+  return almanac;
+}
+
+void save(const almanac_t& almanac, utils::SnapshotWriter& writer) {
+  writer.add(almanac.seeds);
+  writer.add(almanac.seedRanges);
+  writer.add(almanac.mappings);
+  writer.add(almanac.sections);
+}
 
-  alm.setInitialNumbers(seeds);
-  alm_range.setInitialNumbers(seedRanges);
-  while (auto line = lr.getLine()) {
-    // fmt::println("{}", *line);
-    alm.feedLine(*line);
-    alm_range.feedLine(*line);
+almanac_t load(std::shared_ptr<const utils::Snapshot> snapshot) {
+  almanac_t almanac{.storage = snapshot, .seeds = snapshot->section<int64_t>(0), .seedRanges = snapshot->section<range>(1),
+    .mappings = snapshot->section<mapping>(2), .sections = snapshot->section<uint32_t>(3)};
+  // the seed ranges are the seeds in pairs, and the sections cut the mappings up in order
+  const auto& seeds = almanac.seeds;
+  snapshot->check(almanac.seedRanges.size() == seeds.size() / 2, "seed ranges don't match the seeds");
+  for (size_t i = 0; i < almanac.seedRanges.size(); ++i) {
+    snapshot->check(almanac.seedRanges[i].start == seeds[2 * i] && almanac.seedRanges[i].length == seeds[2 * i + 1],
+        "seed ranges don't match the seeds");
   }
-  {
-  auto final1 = alm.getFinalNumbers();
-  auto p1 = *std::min_element(final1.begin(), final1.end());
-  fmt::println("Day5: Part 1: {}", p1);
+  const auto& sections = almanac.sections;
+  snapshot->check(!sections.empty() && sections.front() == 0 && sections.back() == almanac.mappings.size() &&
+      std::ranges::is_sorted(sections), "sections don't cover the mappings in order");
+  return almanac;
+}
+
+// Each section moves the numbers its mappings match, and the rest go through as they are
+template<typename NumberT, bool Debug=false>
+std::vector<NumberT> runAlmanac(const almanac_t& almanac, std::vector<NumberT> current) {
+  if constexpr (Debug) fmt::println("seeds: {}", fmt::join(current, ", "));
+  std::vector<NumberT> next;
+  for (size_t s = 0; s + 1 < almanac.sections.size(); ++s) {
+    for (auto i = almanac.sections[s]; i < almanac.sections[s + 1]; ++i) {
+      mapMappingRule<Debug>(s, current, next, almanac.mappings[i]);
+    }
+    if constexpr (Debug) {
+      if (!current.empty()) fmt::println("Section {} left {} unchanged!", s, fmt::join(current, ", "));
+    }
+    current.insert(current.end(), next.begin(), next.end());
+    next.clear();
   }
-  auto final2 = alm_range.getFinalNumbers();
-  auto p2 = *std::min_element(final2.begin(), final2.end(), [](const range& l, const range& r) { return l.start < r.start; });
-  fmt::println("Day5: Part 2: {}", p2.start);
+  return current;
+}
+
+int64_t part1(const almanac_t& almanac) {
+  auto final1 = runAlmanac(almanac, std::vector<int64_t>(almanac.seeds.begin(), almanac.seeds.end()));
+  return *std::min_element(final1.begin(), final1.end());
+}
+
+int64_t part2(const almanac_t& almanac) {
+  auto final2 = runAlmanac(almanac, std::vector<range>(almanac.seedRanges.begin(), almanac.seedRanges.end()));
+  return std::min_element(final2.begin(), final2.end(), [](const range& l, const range& r) { return l.start < r.start; })->start;
+}
+
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(5, parse, part1, part2, test);
+const bool snapshots = utils::registerSnapshot(5, 1, parse, save, load);
+const bool reparses = utils::registerReparse(5, parse, parseInto);
 }
@@ -1,10 +1,14 @@
+#include "days.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <cmath>
 #include <fmt/core.h>
 #include <string>
 #include <string_view>
+#include <vector>
 
+namespace day6 {
 int eval(int64_t raceTime, int64_t holdTime) {
   return holdTime * (raceTime - holdTime);
 }
@@ -34,28 +38,52 @@ void test() {
   utils::AssertEq(winningTimes(30, 200), 9l);
 }
 
-int main(int argc, char **argv) {
-  // test();
-  // utils::LineReader lr{"inp/day6_test.txt"};
-  utils::LineReader lr{"inp/day6.txt"};
-  auto timeline  = *lr.getLine(); utils::eatLiteral("Time:", timeline);
-  auto distline  = *lr.getLine(); utils::eatLiteral("Distance:", distline);
+struct races_t {
+  std::vector<int64_t> times;
+  std::vector<int64_t> distances;
+  size_t count;
+};
 
-  int64_t winWaysCountProduct = 1;
-  std::string p2time, p2dist;
+// Reuses whatever room result's vectors already have
+void parseInto(std::string_view input, races_t& result) {
+  auto timeline  = *utils::getLine(input); utils::eatLiteral("Time:", timeline);
+  auto distline  = *utils::getLine(input); utils::eatLiteral("Distance:", distline);
 
-  while (!timeline.empty()) {
-    utils::eatSpaces(timeline); utils::eatSpaces(distline);
-    auto time = utils::parseInt(timeline);
-    auto distance = utils::parseInt(distline);
+  // every number takes at least 2 chars with its separator
+  result.times.resize(timeline.size() / 2 + 1);
+  result.distances.resize(distline.size() / 2 + 1);
+  result.count = utils::parseInts(timeline, result.times);
+  utils::AssertEq(utils::parseInts(distline, result.distances), result.count);
+}
 
-    // This is so, so lazy, but I went for a very long bike ride and have dinner plans, sue me
-    p2time += std::to_string(time);
-    p2dist += std::to_string(distance);
+races_t parse(std::string_view input) {
+  races_t result;
+  parseInto(input, result);
+  return result;
+}
+
+int64_t part1(const races_t& races) {
+  int64_t winWaysCountProduct = 1;
+  for (size_t race = 0; race < races.count; ++race) {
+    winWaysCountProduct *= winningTimes(races.times[race], races.distances[race]);
+  }
+  return winWaysCountProduct;
+}
 
-    winWaysCountProduct *= winningTimes(time, distance);
+int64_t part2(const races_t& races) {
+  std::string p2time, p2dist;
+  for (size_t race = 0; race < races.count; ++race) {
+    // This is so, so lazy, but I went for a very long bike ride and have dinner plans, sue me
+    p2time += std::to_string(races.times[race]);
+    p2dist += std::to_string(races.distances[race]);
   }
+  return winningTimes(std::stol(p2time), std::stol(p2dist));
+}
+
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
 
-  fmt::println("Day6: Part 1: {}", winWaysCountProduct);
-  fmt::println("Day6: Part 2: {}", winningTimes(std::stol(p2time), std::stol(p2dist)));
+const bool registered = utils::registerDay(6, parse, part1, part2, test);
+const bool reparses = utils::registerReparse(6, parse, parseInto);
 }
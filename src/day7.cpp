@@ -1,3 +1,5 @@
+#include "days.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
@@ -6,6 +8,7 @@
 #include <string>
 #include <string_view>
 
+namespace day7 {
 enum class HandType : uint8_t {
   UNKNOWN = 0,
   HIGH_CARD,
@@ -16,24 +19,26 @@ enum class HandType : uint8_t {
   FOUR_OF_A_KIND,
   FIVE_OF_A_KIND,
 };
+}
 
-template <> struct fmt::formatter<HandType> {
+template <> struct fmt::formatter<day7::HandType> {
   constexpr auto parse(format_parse_context& ctx) -> format_parse_context::iterator {
     return ctx.end();
   }
-  auto format(const HandType& ht, format_context& ctx) const -> format_context::iterator {
-    if (ht == HandType::UNKNOWN) return fmt::format_to(ctx.out(), "{}", "UNKNOWN");
-    if (ht == HandType::HIGH_CARD) return fmt::format_to(ctx.out(), "{}", "HIGH_CARD");
-    if (ht == HandType::ONE_PAIR) return fmt::format_to(ctx.out(), "{}", "ONE_PAIR");
-    if (ht == HandType::TWO_PAIR) return fmt::format_to(ctx.out(), "{}", "TWO_PAIR");
-    if (ht == HandType::THREE_OF_A_KIND) return fmt::format_to(ctx.out(), "{}", "THREE_OF_A_KIND");
-    if (ht == HandType::FULL_HOUSE) return fmt::format_to(ctx.out(), "{}", "FULL_HOUSE");
-    if (ht == HandType::FOUR_OF_A_KIND) return fmt::format_to(ctx.out(), "{}", "FOUR_OF_A_KIND");
-    if (ht == HandType::FIVE_OF_A_KIND) return fmt::format_to(ctx.out(), "{}", "FIVE_OF_A_KIND");
+  auto format(const day7::HandType& ht, format_context& ctx) const -> format_context::iterator {
+    if (ht == day7::HandType::UNKNOWN) return fmt::format_to(ctx.out(), "{}", "UNKNOWN");
+    if (ht == day7::HandType::HIGH_CARD) return fmt::format_to(ctx.out(), "{}", "HIGH_CARD");
+    if (ht == day7::HandType::ONE_PAIR) return fmt::format_to(ctx.out(), "{}", "ONE_PAIR");
+    if (ht == day7::HandType::TWO_PAIR) return fmt::format_to(ctx.out(), "{}", "TWO_PAIR");
+    if (ht == day7::HandType::THREE_OF_A_KIND) return fmt::format_to(ctx.out(), "{}", "THREE_OF_A_KIND");
+    if (ht == day7::HandType::FULL_HOUSE) return fmt::format_to(ctx.out(), "{}", "FULL_HOUSE");
+    if (ht == day7::HandType::FOUR_OF_A_KIND) return fmt::format_to(ctx.out(), "{}", "FOUR_OF_A_KIND");
+    if (ht == day7::HandType::FIVE_OF_A_KIND) return fmt::format_to(ctx.out(), "{}", "FIVE_OF_A_KIND");
     __builtin_unreachable();
   }
 };
 
+namespace day7 {
 using card_t = uint8_t;
 using counts_t = std::array<uint8_t, 15>;
 
@@ -45,16 +50,19 @@ struct Hand {
   // Fields above are ordered so the default ordering is correct
   auto operator<=>(const Hand& other) const = default;
 };
-template <> struct fmt::formatter<Hand> {
+}
+
+template <> struct fmt::formatter<day7::Hand> {
   constexpr auto parse(format_parse_context& ctx) -> format_parse_context::iterator {
     return ctx.end();
   }
-  auto format(const Hand& h, format_context& ctx) const -> format_context::iterator {
+  auto format(const day7::Hand& h, format_context& ctx) const -> format_context::iterator {
     return fmt::format_to(ctx.out(), 
         "Hand: {} type={} bid={}", fmt::join(h.hand.begin(), h.hand.end(), ","), h.type, h.bid);
   }
 };
 
+namespace day7 {
 // maps a card char to a uint8_t [2,14]
 card_t parseCard(const char c) {
   switch (c) {
@@ -215,22 +223,35 @@ void test() {
   utils::Assert(th.type == HandType::FIVE_OF_A_KIND);
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day7_test.txt"};
-  utils::LineReader lr{"inp/day7.txt"};
-
-  std::vector<Hand> hands;
-  while (auto line = lr.getLine()) {
+// Reuses whatever room hands already has
+void parseInto(std::string_view input, std::vector<Hand>& hands) {
+  hands.clear();
+  while (auto line = utils::getLine(input)) {
     hands.push_back(parseHand(*line));
   }
+}
+
+std::vector<Hand> parse(std::string_view input) {
+  std::vector<Hand> hands;
+  parseInto(input, hands);
+  return hands;
+}
+
+uint64_t part1(std::vector<Hand> hands) {
   std::sort(hands.begin(), hands.end());
-  uint64_t part1 = calculateTotalWinnings(hands);
-  fmt::println("Day7: Part 1: {}", part1);
+  return calculateTotalWinnings(hands);
+}
 
+uint64_t part2(std::vector<Hand> hands) {
   for (auto& h : hands) { jacksToJokers(h); }
   std::sort(hands.begin(), hands.end());
-  uint64_t part2 = calculateTotalWinnings(hands);
-  
-  fmt::println("Day7: Part 2: {}", part2);
+  return calculateTotalWinnings(hands);
+}
+
+utils::Answers<uint64_t, uint64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(7, parse, part1, part2, test);
+const bool reparses = utils::registerReparse(7, parse, parseInto);
 }
@@ -1,70 +1,72 @@
+#include "days.hpp"
+#include "intern.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
+#include "trace.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
 #include <algorithm>
+#include <array>
 #include <fmt/format.h>
 #include <numeric>
+#include <stdexcept>
 #include <vector>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <map>
 
-struct Node {
-  std::string name;
-  std::string left;
-  std::string right;
+namespace day8 {
+// A line of the input as it's written
+struct node_line_t {
+  std::string_view name;
+  std::string_view left;
+  std::string_view right;
 };
 
-template <> struct fmt::formatter<Node> {
-  constexpr auto parse(format_parse_context& ctx) -> format_parse_context::iterator {
-    return ctx.end();
-  }
-  auto format(const Node& r, format_context& ctx) const -> format_context::iterator {
-    return fmt::format_to(ctx.out(), "{} = ({}, {})", r.name, r.left, r.right);
-  }
+node_line_t parseNode(std::string_view line) {
+  auto [name, left, right] = utils::scan<"{} = ({}, {})",
+       std::string_view, std::string_view, std::string_view>(line);
+  return {.name = name, .left = left, .right = right};
+}
+
+// Nodes go by number rather than by name. next is where L and R go.
+using node_id = uint32_t;
+
+struct node_t {
+  std::array<node_id, 2> next;
 };
 
-using graph_t = std::unordered_map<std::string, Node>;
-
-Node parseNode(std::string_view line) {
-  Node result;
-  result.name = utils::readWord(line);
-  utils::Assert(utils::eatLiteral(" = (", line));
-  result.left = utils::readWord(line);
-  result.left = result.left.substr(0, 3);
-  utils::Assert(utils::eatLiteral(" ", line));
-  result.right = utils::readWord(line);
-  result.right = result.right.substr(0, 3);
-  return result;
-}
+struct network_t {
+  std::string instructions;
+  utils::InternTable ids;
+  std::vector<node_t> nodes;
+  std::vector<bool> exits; // names ending in Z
+  std::vector<node_id> starts; // names ending in A
+
+  node_id step(node_id node, char inst) const { return nodes[node].next[inst == 'R']; }
+};
 
 template<bool Debug = false>
-int64_t countSteps(std::string_view inst, const graph_t& graph) {
+int64_t countSteps(const network_t& network) {
+  const auto& inst = network.instructions;
   int64_t result = 0;
   size_t idx = 0;
-  std::string current_node = "AAA";
-  while (current_node != "ZZZ") {
-    if constexpr (Debug) fmt::print("Going from {}, {} -> ", current_node, inst[idx]);
-    switch (inst[idx]) {
-      case 'L': current_node = graph.at(current_node).left;
-                break;
-      case 'R': current_node = graph.at(current_node).right;
-                break;
-    }
-    if constexpr (Debug) fmt::println("{}", current_node);
+  node_id current_node = network.ids.find("AAA").value();
+  const node_id end = network.ids.find("ZZZ").value();
+  while (current_node != end) {
+    if constexpr (Debug) fmt::print("Going from {}, {} -> ", network.ids.name(current_node), inst[idx]);
+    current_node = network.step(current_node, inst[idx]);
+    if constexpr (Debug) fmt::println("{}", network.ids.name(current_node));
     idx = (idx + 1) % inst.size();
     ++result;
   }
   return result;
 }
 
-bool atExit(const std::string& n) {
-  return n.back() == 'Z';
-}
-
 struct search_state_t {
   int idx;
-  std::string node;
+  node_id node;
   size_t stepCount = 0;
   auto operator<=>(const search_state_t&) const = default;
 };
@@ -72,59 +74,54 @@ struct search_state_t {
 using z_graph = std::map<search_state_t, search_state_t>;
 
 template<bool Debug>
-search_state_t countStepsPart2(std::string_view inst, const graph_t& graph, std::string startNode, int startIdx) {
+search_state_t countStepsPart2(const network_t& network, node_id startNode, int startIdx) {
+  const auto& inst = network.instructions;
   search_state_t result { .idx = startIdx, .node = startNode, .stepCount = 0};
 
   do {
-    if constexpr (Debug) fmt::print("Going from {}, {} -> ", result.node, inst[result.idx]);
-    switch (inst[result.idx]) {
-      case 'L': result.node = graph.at(result.node).left;
-                break;
-      case 'R': result.node = graph.at(result.node).right;
-                break;
-    }
-    if constexpr (Debug) {fmt::println("{}", result.node);}
+    if constexpr (Debug) fmt::print("Going from {}, {} -> ", network.ids.name(result.node), inst[result.idx]);
+    result.node = network.step(result.node, inst[result.idx]);
+    if constexpr (Debug) {fmt::println("{}", network.ids.name(result.node));}
 
     result.idx = (result.idx + 1) % inst.size();
     ++result.stepCount;
-  } while (!atExit(result.node));
+  } while (!network.exits[result.node]);
   return result;
 }
 
+// How many steps a ghost takes to get round its loop, found by jumping from exit to exit
+// until it's back at one it's been at before
 template<bool Debug>
-size_t part2(std::string_view inst, const graph_t& graph) {
+size_t ghostLoopLength(const network_t& network, node_id start) {
   z_graph zg;
-  std::vector<search_state_t> currentNodes;
-  for (const auto [name, _node] : graph)
-    { if (name.back() == 'A') currentNodes.push_back({.idx = 0, .node = name, .stepCount = 0}); }
-
-  std::vector<size_t> loopLengths;
-
-  for (auto& it : currentNodes) {
-    auto current_state = it;
-    while (!zg.contains(current_state)) {
-        auto next = countStepsPart2<Debug>(inst, graph, current_state.node, current_state.idx);
-        zg.emplace(current_state, next);
-        it.idx = next.idx;
-        it.node = next.node;
-        it.stepCount += next.stepCount;
-        current_state = it;
-        current_state.stepCount = 0;
-    }
-  }
-  for (auto current_state : currentNodes) {
-    auto mapped_cs = current_state;
-    mapped_cs.stepCount = 0;
-    auto next = zg.at(mapped_cs);
-    if constexpr (Debug) fmt::println("Using cached result for {},{} -> {} -> {} in {}", current_state.node, current_state.idx, next.node, next.idx, next.stepCount);
-    utils::Assert(next.node == current_state.node); // This seems to be true, but is not generally the case :/
-    utils::Assert(current_state.stepCount % next.stepCount == 0); // This seems to be true, but is not generally the case :/
-    loopLengths.push_back(next.stepCount);
+  search_state_t it{.idx = 0, .node = start, .stepCount = 0};
+  auto current_state = it;
+  while (!zg.contains(current_state)) {
+      auto next = countStepsPart2<Debug>(network, current_state.node, current_state.idx);
+      zg.emplace(current_state, next);
+      it.idx = next.idx;
+      it.node = next.node;
+      it.stepCount += next.stepCount;
+      current_state = it;
+      current_state.stepCount = 0;
   }
 
-  size_t result = loopLengths.front();
-  for (const auto l : loopLengths) { result = std::lcm(result, l); }
-  return result;
+  auto next = zg.at(current_state);
+  if constexpr (Debug) fmt::println("Using cached result for {},{} -> {} -> {} in {}", network.ids.name(it.node), it.idx,
+      network.ids.name(next.node), next.idx, next.stepCount);
+  utils::Assert(next.node == it.node); // This seems to be true, but is not generally the case :/
+  utils::Assert(it.stepCount % next.stepCount == 0); // This seems to be true, but is not generally the case :/
+  return next.stepCount;
+}
+
+// Ghosts don't affect each other, so each is followed on the pool
+template<bool Debug>
+size_t countGhostSteps(const network_t& network) {
+  utils::TraceScope trace{"ghost search"};
+  const auto& starts = network.starts;
+  return utils::parallelReduce(0, starts.size(), size_t{1},
+      [&](size_t& acc, size_t i) { acc = std::lcm(acc, ghostLoopLength<Debug>(network, starts[i])); },
+      [](size_t lhs, size_t rhs) { return std::lcm(lhs, rhs); });
 }
 
 void test() {
@@ -134,22 +131,57 @@ void test() {
   utils::Assert(n.right == "CCC");
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day8_test1.txt"};
-  // utils::LineReader lr{"inp/day8_test3.txt"};
-  utils::LineReader lr{"inp/day8.txt"};
-  std::string instructions{*lr.getLine()};
-  utils::Assert(lr.getLine()->empty());
-  graph_t graph;
-
-  while (auto line = lr.getLine()) {
-    auto n = parseNode(*line);
-    // fmt::println("{}", n);
-    graph.emplace(n.name, n);
+void parseInto(std::string_view input, network_t& network) {
+  auto lines = utils::lines(input);
+  auto line = lines.begin();
+  network.instructions = *line;
+  network.ids.clear(input.size() / 16);
+  network.nodes.clear();
+  network.exits.clear();
+  network.starts.clear();
+  utils::Assert((*++line).empty());
+
+  std::vector<bool> defined;
+  for (auto text : std::ranges::subrange{++line, lines.end()}) {
+    const auto n = parseNode(text);
+    const auto id = network.ids.intern(n.name);
+    const node_t node{.next = {network.ids.intern(n.left), network.ids.intern(n.right)}};
+    if (network.nodes.size() <= id) {
+      network.nodes.resize(id + 1);
+      defined.resize(id + 1);
+    }
+    if (defined[id]) throw std::invalid_argument(fmt::format("node {} is defined twice", n.name));
+    network.nodes[id] = node;
+    defined[id] = true;
   }
-  auto p1 = countSteps<false>(instructions, graph);
-  fmt::println("Day8: Part 1: {}", p1);
-  auto p2 = part2<false>(instructions, graph);
-  fmt::println("Day8: Part 2: {}", p2);
+  defined.resize(network.ids.size());
+  if (const auto missing = std::ranges::find(defined, false); missing != defined.end())
+    throw std::invalid_argument(fmt::format("node {} is gone to but never defined", network.ids.name(missing - defined.begin())));
+  for (node_id id = 0; id < network.ids.size(); ++id) {
+    const auto name = network.ids.name(id);
+    network.exits.push_back(name.ends_with('Z'));
+    if (name.ends_with('A')) network.starts.push_back(id);
+  }
+}
+
+network_t parse(std::string_view input) {
+  network_t network;
+  parseInto(input, network);
+  return network;
+}
+
+int64_t part1(const network_t& network) {
+  return countSteps<false>(network);
+}
+
+size_t part2(const network_t& network) {
+  return countGhostSteps<false>(network);
+}
+
+utils::Answers<int64_t, size_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(8, parse, part1, part2, test, 5);
+const bool reparses = utils::registerReparse(8, parse, parseInto);
 }
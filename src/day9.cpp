@@ -1,3 +1,6 @@
+#include "days.hpp"
+#include "parallel.hpp"
+#include "registry.hpp"
 #include "utils.hpp"
 
 #include <algorithm>
@@ -5,19 +8,18 @@
 #include <vector>
 #include <string_view>
 
+namespace day9 {
 using history_t = std::vector<int64_t>;
 
 history_t parseHistory(std::string_view line) {
-  history_t result;
-  while (!line.empty()) {
-    result.push_back(utils::parseInt(line));
-    utils::eatSpaces(line);
-  }
+  // every number takes at least 2 chars with its separator
+  history_t result(line.size() / 2 + 1);
+  result.resize(utils::parseInts(line, result));
   return result;
 }
 
 template<bool Debug>
-int64_t part1(history_t hist) {
+int64_t extrapolate(history_t hist) {
   // We can repeatedly apply the diff to the history, and accumulate the last entry in
   // the (shortening) list every time into the result;
   int64_t result = hist.back();
@@ -41,19 +43,35 @@ void test() {
   utils::Assert(parseHistory("0 3 6 9 12 15").size() == 6);
 }
 
-int main(int argc, char **argv) {
-  test();
-  // utils::LineReader lr{"inp/day9_test.txt"};
-  utils::LineReader lr{"inp/day9.txt"};
+using histories_t = std::vector<history_t>;
+
+histories_t parse(std::string_view input) {
+  return utils::reduceLines(input, histories_t{},
+      [](histories_t& acc, std::string_view line) { acc.push_back(parseHistory(line)); },
+      [](histories_t l, histories_t r) {
+        std::move(r.begin(), r.end(), std::back_inserter(l));
+        return l;
+      });
+}
+
+int64_t part1(const histories_t& histories) {
+  int64_t result = 0;
+  for (const auto& history : histories) result += extrapolate<false>(history);
+  return result;
+}
 
-  int64_t p1 = 0;
-  int64_t p2 = 0;
-  while (auto line = lr.getLine()) {
-    auto history = parseHistory(*line);
-    p1 += part1<false>(history);
+int64_t part2(const histories_t& histories) {
+  int64_t result = 0;
+  for (auto history : histories) {
     std::reverse(history.begin(), history.end());
-    p2 += part1<false>(history);
+    result += extrapolate<false>(history);
   }
-  fmt::println("Day9: Part 1: {}", p1);
-  fmt::println("Day9: Part 2: {}", p2);
+  return result;
+}
+
+utils::Answers<int64_t, int64_t> solve(std::string_view input) {
+  return utils::solveWith(input, parse, part1, part2);
+}
+
+const bool registered = utils::registerDay(9, parse, part1, part2, test);
 }
@@ -0,0 +1,44 @@
+#include "inputgen.hpp"
+#include "utils.hpp"
+
+#include <cstdio>
+#include <fmt/format.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Writes a made up input for a day to stdout
+//
+//   gen 7 1000000 > big7.txt     a million hands for day 7
+//   gen 17 4096 42               a 4096x4096 day 17 grid from seed 42
+//   gen 5                        day 5 at about the size of a real input
+
+// The whole argument has to be a number
+std::optional<int64_t> parseArg(std::string_view arg) {
+  const auto result = utils::tryParseInt(arg);
+  if (!result || !arg.empty()) return std::nullopt;
+  return *result;
+}
+
+int main(int argc, char **argv) {
+  std::optional<int64_t> day, scale = 0, seed = 0;
+  if (argc >= 2 && argc <= 4) {
+    day = parseArg(argv[1]);
+    if (argc > 2) scale = parseArg(argv[2]);
+    if (argc > 3) seed = parseArg(argv[3]);
+  }
+  if (!day || *day < 1 || *day > 20 || !scale || *scale < 0 || !seed) {
+    fmt::println(stderr, "usage: {} day [scale [seed]]", argv[0]);
+    return 1;
+  }
+
+  std::string input;
+  try {
+    input = utils::generateInput(*day, *scale, *seed);
+  } catch (const std::invalid_argument& e) {
+    fmt::println(stderr, "{}", e.what());
+    return 1;
+  }
+  fwrite(input.data(), 1, input.size(), stdout);
+}
@@ -0,0 +1,112 @@
+# Runs bench_days and fails if any benchmark got slower than the baseline's by more than
+# TOLERANCE percent and by more than FLOOR ns as well. With -DRECORD=ON it writes the
+# baseline instead.
+#
+#   cmake -DBENCH=build/bench_days -DBASELINE=bench_baseline.json -DOUTPUT=build/bench.json \
+#         -DTOLERANCE=10 -DFLOOR=10000 -P bench_gate.cmake
+#
+# Each benchmark is run five times and the fastest is what's compared, since anything else
+# running on the machine only ever adds time. The floor stops benchmarks that take a few
+# microseconds failing on the odd microsecond of noise.
+#
+# Baselines only mean anything on the machine they were recorded on, so there isn't one
+# checked in. Without one it says so and the test is marked skipped.
+
+set(flags --benchmark_repetitions=5 --benchmark_out_format=json)
+
+if(RECORD)
+  execute_process(COMMAND ${BENCH} ${flags} --benchmark_out=${BASELINE} RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "bench_days failed: ${result}")
+  endif()
+  message(STATUS "baseline written to ${BASELINE}")
+  return()
+endif()
+
+if(NOT FLOOR)
+  set(FLOOR 0)
+endif()
+
+if(NOT EXISTS ${BASELINE})
+  message(STATUS "no baseline at ${BASELINE}, build the bench_baseline target to record one")
+  return()
+endif()
+
+execute_process(COMMAND ${BENCH} ${flags} --benchmark_out=${OUTPUT} OUTPUT_QUIET RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "bench_days failed: ${result}")
+endif()
+
+# Fastest real time of every benchmark over its repetitions in a results file, in ns, as
+# <prefix>_<name> variables and the names in <prefix>_names
+function(read_fastest file prefix)
+  file(READ ${file} json)
+  string(JSON count LENGTH "${json}" benchmarks)
+  set(names)
+  if(count GREATER 0)
+    math(EXPR last "${count} - 1")
+    foreach(i RANGE ${last})
+      string(JSON type ERROR_VARIABLE missing GET "${json}" benchmarks ${i} run_type)
+      if(missing OR NOT type STREQUAL "iteration")
+        continue()
+      endif()
+      string(JSON name GET "${json}" benchmarks ${i} run_name)
+      string(JSON time GET "${json}" benchmarks ${i} real_time)
+      string(JSON unit GET "${json}" benchmarks ${i} time_unit)
+      # No floats in CMake, so keep three decimal places in an integer
+      if(NOT time MATCHES "^([0-9]+)(\\.([0-9]*))?$")
+        message(FATAL_ERROR "can't read the time '${time}' for ${name} in ${file}")
+      endif()
+      string(SUBSTRING "${CMAKE_MATCH_3}000" 0 3 fraction)
+      set(scale 1)
+      if(unit STREQUAL "us")
+        set(scale 1000)
+      elseif(unit STREQUAL "ms")
+        set(scale 1000000)
+      elseif(unit STREQUAL "s")
+        set(scale 1000000000)
+      endif()
+      math(EXPR time "(${CMAKE_MATCH_1} * 1000 + 1${fraction} - 1000) * ${scale} / 1000")
+      if(NOT DEFINED fastest_${name})
+        list(APPEND names ${name})
+        set(fastest_${name} ${time})
+      elseif(time LESS fastest_${name})
+        set(fastest_${name} ${time})
+      endif()
+    endforeach()
+  endif()
+  if(NOT names)
+    message(FATAL_ERROR "no repetitions in ${file}, it may be from before the gate compared the fastest of them; build the bench_baseline target to record it again")
+  endif()
+  foreach(name ${names})
+    set(${prefix}_${name} ${fastest_${name}} PARENT_SCOPE)
+  endforeach()
+  set(${prefix}_names ${names} PARENT_SCOPE)
+endfunction()
+
+read_fastest(${BASELINE} baseline)
+read_fastest(${OUTPUT} current)
+
+set(slower)
+foreach(name ${current_names})
+  if(NOT DEFINED baseline_${name})
+    message(STATUS "${name}: not in the baseline")
+    continue()
+  endif()
+  set(before ${baseline_${name}})
+  set(after ${current_${name}})
+  if(before EQUAL 0)
+    set(before 1)
+  endif()
+  math(EXPR change "(${after} - ${before}) * 100 / ${before}")
+  math(EXPR added "${after} - ${before}")
+  message(STATUS "${name}: ${before} ns -> ${after} ns (${change}%)")
+  if(change GREATER TOLERANCE AND added GREATER FLOOR)
+    list(APPEND slower "${name} ${change}%")
+  endif()
+endforeach()
+
+if(slower)
+  string(REPLACE ";" "\n  " slower "${slower}")
+  message(FATAL_ERROR "slower than the baseline by more than ${TOLERANCE}% (and ${FLOOR} ns):\n  ${slower}")
+endif()
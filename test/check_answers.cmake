@@ -0,0 +1,57 @@
+# Runs one day through aoc and compares the answers it prints with the recorded ones
+#
+#   cmake -DAOC=build/aoc -DDAY=5 -DINPUT=inp/day5.txt -DANSWERS=inp/answers.txt -P check_answers.cmake
+#
+# With -DGEN=build/gen the input is written by `gen DAY` first, at its usual scale and seed.
+# With -DCACHE=some.bin it's solved twice through a fresh answer cache there (aoc -c), so the
+# second time the answers have to come out of the cache. With -DSNAPSHOT=ON it's solved once writing
+# a snapshot (aoc -w) and then again from the snapshot.
+# Answers files have a line per part just as aoc prints them; lines for other days and
+# ones starting with # are ignored.
+
+# "first" and "second" below are both run names and variables
+cmake_policy(SET CMP0054 NEW)
+
+if(GEN)
+  execute_process(COMMAND ${GEN} ${DAY} OUTPUT_FILE ${INPUT} RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "gen ${DAY} failed: ${result}")
+  endif()
+endif()
+
+file(STRINGS ${ANSWERS} expected REGEX "^Day${DAY}: ")
+if(NOT expected)
+  message(FATAL_ERROR "no answers for day ${DAY} in ${ANSWERS}")
+endif()
+
+# Each run is aoc's arguments for it
+set(first ${DAY}=${INPUT})
+if(CACHE)
+  file(REMOVE ${CACHE})
+  set(first -c${CACHE} ${DAY}=${INPUT})
+  set(second -c${CACHE} ${DAY}=${INPUT})
+elseif(SNAPSHOT)
+  set(first -w ${DAY}=${INPUT})
+  set(second ${DAY}=${INPUT}.snap)
+endif()
+foreach(run first second)
+  if(NOT DEFINED ${run})
+    continue()
+  endif()
+  execute_process(COMMAND ${AOC} ${${run}} OUTPUT_VARIABLE output ERROR_VARIABLE errors RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    string(REPLACE ";" " " args "${${run}}")
+    message(FATAL_ERROR "aoc ${args} failed: ${result}")
+  endif()
+
+  string(REGEX MATCHALL "Day${DAY}: [^\n]*" actual "${output}")
+  if(NOT actual STREQUAL expected)
+    string(REPLACE ";" "\n  " expected "${expected}")
+    string(REPLACE ";" "\n  " actual "${actual}")
+    message(FATAL_ERROR "wrong answers for ${INPUT} (${run} run)\nexpected\n  ${expected}\ngot\n  ${actual}")
+  endif()
+  # right answers from a cache that never hits would prove nothing
+  if(CACHE AND run STREQUAL "second" AND NOT errors MATCHES "answer cache: 1 hits, 0 misses")
+    message(FATAL_ERROR "the second run didn't answer from the cache:\n${errors}")
+  endif()
+endforeach()
@@ -0,0 +1,36 @@
+# Runs batch on one thread on a directory holding a generated input twice, and checks both
+# copies' answers. The second copy is parsed into what the first left behind, for days
+# that reparse. With BAD on there's also a file that isn't an input at all, and the good
+# answers have to still come out next to an error for it.
+#
+#   cmake -DBATCH=build/batch -DGEN=build/gen -DDAY=19 -DDIR=batch_test -DANSWERS=test/answers.txt -DBAD=ON -P check_batch.cmake
+
+file(REMOVE_RECURSE ${DIR})
+file(MAKE_DIRECTORY ${DIR})
+execute_process(COMMAND ${GEN} ${DAY} OUTPUT_FILE ${DIR}/good.txt RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "gen ${DAY} failed: ${result}")
+endif()
+file(COPY_FILE ${DIR}/good.txt ${DIR}/good_again.txt)
+if(BAD)
+  file(WRITE ${DIR}/bad.txt "abcd")
+endif()
+
+file(STRINGS ${ANSWERS} expected REGEX "^Day${DAY}: ")
+list(TRANSFORM expected REPLACE "^Day${DAY}: Part [12]: " "")
+list(JOIN expected "," expected)
+
+execute_process(COMMAND ${BATCH} -j1 ${DAY} ${DIR} OUTPUT_VARIABLE output RESULT_VARIABLE result)
+if(BAD AND result EQUAL 0)
+  message(FATAL_ERROR "batch didn't report the bad input")
+elseif(NOT BAD AND NOT result EQUAL 0)
+  message(FATAL_ERROR "batch failed: ${result}\n${output}")
+endif()
+foreach(good good.txt good_again.txt)
+  if(NOT output MATCHES "${DAY},[^,\n]*${good},${expected},false,")
+    message(FATAL_ERROR "no answers ${expected} for ${good} in\n${output}")
+  endif()
+endforeach()
+if(BAD AND NOT output MATCHES "${DAY},[^,\n]*bad.txt,,,false,[0-9.]+,[^\n]+")
+  message(FATAL_ERROR "no error for the bad input in\n${output}")
+endif()
@@ -0,0 +1,57 @@
+#include "days.hpp"
+#include "inputgen.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <fmt/format.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// Checks every day's typed solve() on the same generated inputs, and against the same
+// answers, as the day*_generated tests, only calling the days straight from aoc_days
+// rather than through the driver.
+//
+//   solve_days test/answers.txt
+
+template<auto Solve>
+std::vector<std::string> answerLines(int day, std::string_view input) {
+  const auto answers = Solve(input);
+  std::vector<std::string> lines{fmt::format("Day{}: Part 1: {}", day, answers.part1)};
+  if constexpr (!std::is_same_v<std::decay_t<decltype(answers.part2)>, std::monostate>)
+    lines.push_back(fmt::format("Day{}: Part 2: {}", day, answers.part2));
+  return lines;
+}
+
+constexpr std::array solvers{
+  answerLines<day1::solve>, answerLines<day2::solve>, answerLines<day3::solve>, answerLines<day4::solve>,
+  answerLines<day5::solve>, answerLines<day6::solve>, answerLines<day7::solve>, answerLines<day8::solve>,
+  answerLines<day9::solve>, answerLines<day10::solve>, answerLines<day11::solve>, answerLines<day12::solve>,
+  answerLines<day13::solve>, answerLines<day14::solve>, answerLines<day15::solve>, answerLines<day16::solve>,
+  answerLines<day17::solve>, answerLines<day18::solve>, answerLines<day19::solve>, answerLines<day20::solve>,
+};
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fmt::println(stderr, "usage: {} answers.txt", argv[0]);
+    return 1;
+  }
+  utils::LineReader lr{argv[1]};
+  std::string_view expected = lr.contents();
+
+  int failures = 0;
+  for (size_t i = 0; i < solvers.size(); ++i) {
+    const int day = i + 1;
+    const auto input = utils::generateInput(day);
+    for (const auto& line : solvers[i](day, input)) {
+      if (expected.find(line + '\n') == expected.npos) {
+        fmt::println(stderr, "{} isn't in {}", line, argv[1]);
+        ++failures;
+      }
+    }
+  }
+  if (failures) return 1;
+  fmt::println("all {} days match", solvers.size());
+}
@@ -0,0 +1,130 @@
+#include "bitgrid.hpp"
+#include "intern.hpp"
+#include "utils.hpp"
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <fmt/core.h>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Checks for the helpers in include/ on the inputs the days' own tests never see: too many
+// numbers, numbers too big, lines that don't match, tables that have to grow, and so on.
+//
+//   utils_tests
+
+template<typename E>
+bool throws(const std::function<void()>& f) {
+  try { f(); } catch (const E&) { return true; }
+  return false;
+}
+
+void testParseInts() {
+  std::array<int64_t, 4> out;
+  utils::AssertEq(utils::parseInts("1 -2 x3", out), size_t{3});
+  utils::AssertEq(out[1], int64_t{-2});
+  // More numbers than fit
+  utils::Assert(throws<std::out_of_range>([] {
+    std::array<int64_t, 2> two;
+    utils::parseInts("1 2 3", two);
+  }));
+  // The extremes fit, one past them doesn't
+  utils::AssertEq(utils::parseInts("9223372036854775807 -9223372036854775808", out), size_t{2});
+  utils::AssertEq(out[0], std::numeric_limits<int64_t>::max());
+  utils::AssertEq(out[1], std::numeric_limits<int64_t>::min());
+  utils::Assert(throws<std::out_of_range>([&] { utils::parseInts("9223372036854775808", out); }));
+  utils::Assert(throws<std::out_of_range>([&] { utils::parseInts("18446744073709551615", out); }));
+  utils::Assert(throws<std::out_of_range>([&] { utils::parseInts("-9223372036854775809", out); }));
+  // Bytes past ascii are separators like anything else
+  utils::AssertEq(utils::parseInts("\xff" "12\x80" "34", out), size_t{2});
+  utils::AssertEq(out[1], int64_t{34});
+}
+
+void testScan() {
+  const auto [id, rest] = utils::scan<"Game {}: {}", int, std::string_view>("Game 12: 3 red");
+  utils::AssertEq(id, 12);
+  utils::AssertEq(rest, std::string_view{"3 red"});
+  utils::Assert(throws<std::invalid_argument>([] { utils::scan<"Game {}: {}", int, std::string_view>("Game x: 3 red"); }));
+  utils::Assert(throws<std::invalid_argument>([] { utils::scan<"Game {}", int>("Gone 12"); }));
+  // Integers have to fit their fields
+  utils::AssertEq(std::get<0>(utils::scan<"{}", int8_t>("-128")), int8_t{-128});
+  utils::Assert(throws<std::out_of_range>([] { utils::scan<"{}", int8_t>("128"); }));
+  utils::Assert(throws<std::out_of_range>([] { utils::scan<"{}", uint32_t>("-1"); }));
+  // Trusted input doesn't have its literals checked, but still has to have its integers
+  utils::AssertEq(std::get<0>(utils::scanTrusted<"Game {}: {}", int, std::string_view>("Game 12: 3 red")), 12);
+  utils::Assert(throws<std::invalid_argument>([] { utils::scanTrusted<"Game {}: {}", int, std::string_view>("Game x: 3 red"); }));
+}
+
+void testInternTable() {
+  utils::InternTable ids;
+  utils::AssertEq(ids.intern("AAA"), 0u);
+  utils::AssertEq(ids.intern("a name too long to go inline"), 1u);
+  utils::AssertEq(ids.intern("AAA"), 0u);
+  utils::AssertEq(*ids.find("a name too long to go inline"), 1u);
+  utils::AssertEq(ids.name(1), std::string_view{"a name too long to go inline"});
+  // Missing names aren't added by looking for them
+  utils::Assert(!ids.find("BBB"));
+  utils::Assert(!ids.find(""));
+  utils::AssertEq(ids.size(), size_t{2});
+
+  // Starting from one group, enough names that it has to grow several times and that
+  // plenty of them share control bytes, including some past the 255 a slot's length holds
+  std::vector<std::string> names;
+  for (size_t i = 0; i < 5000; ++i) names.push_back(i % 500 == 0 ? std::string(300 + i / 500, 'x') : fmt::format("n{}", i));
+  utils::InternTable grown;
+  for (size_t i = 0; i < names.size(); ++i) utils::AssertEq(grown.intern(names[i]), static_cast<uint32_t>(i));
+  utils::AssertEq(grown.size(), names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    utils::AssertEq(grown.intern(names[i]), static_cast<uint32_t>(i));
+    utils::Assert(grown.find(names[i]) == static_cast<uint32_t>(i));
+    utils::AssertEq(grown.name(i), std::string_view{names[i]});
+  }
+  // Same length as the long ones, but a different key
+  utils::Assert(!grown.find(std::string(300, 'y')));
+  utils::Assert(!grown.find("n5000"));
+}
+
+void testBitGrid() {
+  // Shifts carry across words, drop what goes off the edge and leave empty rows alone
+  utils::BitGrid g(70, 2);
+  g.set(0, 63);
+  g.set(0, 69);
+  g.shiftRight(1);
+  utils::Assert(g.test(0, 64));
+  utils::AssertEq(g.count(), size_t{1});
+  g.shiftLeft(2);
+  utils::Assert(g.test(0, 62));
+  utils::AssertEq(g.count(), size_t{1});
+  utils::BitGrid empty(0, 3);
+  empty.shiftRight(1);
+  empty.shiftLeft(1);
+  utils::Assert(empty.none());
+}
+
+constexpr std::pair<const char*, void (*)()> tests[] = {
+  {"parseInts", testParseInts},
+  {"scan", testScan},
+  {"InternTable", testInternTable},
+  {"BitGrid", testBitGrid},
+};
+
+int main() {
+  int failures = 0;
+  for (const auto& [name, test] : tests) {
+    try {
+      test();
+    } catch (const std::exception& e) {
+      fmt::println(stderr, "{}: {}", name, e.what());
+      ++failures;
+    }
+  }
+  if (failures) return 1;
+  fmt::println("all {} utils tests pass", std::size(tests));
+}